@@ -0,0 +1,42 @@
+#include "UnitTest.hpp"
+
+// Run it with and without --leaks: the counted allocations must not change
+UT_TRACK_ALLOCATIONS();
+
+UT_TEST_SUITE(AllocationSuite) {
+
+   int *sink = nullptr;
+
+   // It releases the block allocated by the cases, so that they do not leak
+   UT_TEST_CASE_CLEANUP() {
+                              delete sink;
+                              sink = nullptr;
+                          };
+
+   UT_TEST_CASE(With_one_allocation_counted_once, allocations) {
+       UnitTest::AllocationCounters found = UnitTest::Allocations::measure([&]() -> void { sink = new int(1); });
+       AssertEquals(found.allocations, 1);
+   };
+
+   UT_TEST_CASE(With_one_allocation_allowed, allocations) {
+       AssertMaxAllocations(1, (sink = new int(1)));
+   };
+
+   UT_TEST_CASE(With_no_allocation, allocations) {
+       int value = 0;
+       AssertNoAllocations(value += 1);
+       AssertEquals(value, 1);
+   };
+
+   UT_ENABLE_TEST_CASES(
+      With_one_allocation_counted_once,
+      With_one_allocation_allowed,
+      With_no_allocation
+   );
+};
+
+int main(int argc, char **argv) {
+   UT_REGISTER_TEST_SUITE(AllocationSuite);
+   UnitTest::TestManager::run(argc, argv);
+   return 0;
+}
@@ -25,12 +25,31 @@ DEALINGS IN THE SOFTWARE.
 #ifndef _UNIT_TEST_HPP_
 #define _UNIT_TEST_HPP_
 
+#include "UnitTest_Allocations.hpp"
 #include "UnitTest_Asserts.hpp"
+#include "UnitTest_Baseline.hpp"
+#include "UnitTest_Benchmark.hpp"
+#include "UnitTest_Complexity.hpp"
 #include "UnitTest_Console.hpp"
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_Durations.hpp"
+#include "UnitTest_Environment.hpp"
+#include "UnitTest_Filter.hpp"
+#include "UnitTest_Histogram.hpp"
+#include "UnitTest_LoadGen.hpp"
+#include "UnitTest_Memory.hpp"
+#include "UnitTest_Profiler.hpp"
+#include "UnitTest_Registry.hpp"
 #include "UnitTest_Requires.hpp"
+#include "UnitTest_Resources.hpp"
 #include "UnitTest_Shared.hpp"
+#include "UnitTest_Statistics.hpp"
 #include "UnitTest_TestManager.hpp"
+#include "UnitTest_Timing.hpp"
+#include "UnitTest_Trace.hpp"
+#include "UnitTest_Typed.hpp"
 #include "UnitTest_Utility.hpp"
+#include "UnitTest_Workers.hpp"
 
 #endif
 
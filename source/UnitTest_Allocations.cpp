@@ -0,0 +1,293 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <unordered_map>
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <mutex>
+#include <map>
+
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Utility.hpp"
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define UT_HAS_BACKTRACE 1
+#endif
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#elif defined(__linux__) || defined(__unix__)
+#include <malloc.h>
+#endif
+
+std::atomic<bool> UnitTest::Allocations::m_enabled(false);
+std::atomic<bool> UnitTest::Allocations::m_leaks(false);
+
+namespace {
+
+   // The largest number of frames of the call stack of a recorded block
+   const int MAX_FRAMES = 24;
+
+   // The largest number of frames written for a leak
+   const size_t REPORTED_FRAMES = 10;
+
+   // The largest number of frames of the allocation functions at the top of a call stack
+   const size_t ALLOCATOR_FRAMES = 4;
+
+   // A block allocated while a scope was open
+   struct Block {
+      uint64_t scope;
+      size_t size;
+      int depth;
+      void *frames[MAX_FRAMES];
+   };
+
+   // The counters of each thread (zero-initialized, so that they can be used by allocations
+   // performed before any constructor is executed)
+   thread_local UnitTest::AllocationCounters t_counters;
+
+   // The scope open on each thread (0 when none is)
+   thread_local uint64_t t_scope;
+
+   // The number of Pause objects alive on each thread
+   thread_local int t_paused;
+
+   // It holds whether the thread is updating the recorded blocks (their own allocations are not recorded)
+   thread_local bool t_busy;
+
+   // The last scope opened
+   std::atomic<uint64_t> g_scopes(0);
+
+   // The recorded blocks and their mutex, they are never destroyed since blocks can be freed
+   // during the destruction of static objects
+   std::unordered_map<void *, Block> &blocks() {
+      static std::unordered_map<void *, Block> *blocks = new std::unordered_map<void *, Block>();
+      return *blocks;
+   }
+
+   std::mutex &blocks_mutex() {
+      static std::mutex *mutex = new std::mutex();
+      return *mutex;
+   }
+
+   // The live memory of the calling thread (blocks freed by other threads can make it negative)
+   uint64_t live_bytes() {
+      return (t_counters.allocated_bytes > t_counters.freed_bytes) ? t_counters.allocated_bytes - t_counters.freed_bytes : 0;
+   }
+
+   // It tells whether a frame belongs to the allocation functions
+   bool is_allocator(const std::string &symbol) {
+      static const char *ALLOCATORS[] = {
+         "UnitTest::Allocations::", "malloc+", "calloc+", "realloc+", "memalign+", "aligned_alloc+", "posix_memalign+",
+         "valloc+", "pvalloc+", "operator new"
+      };
+      for (size_t idx = 0; idx < sizeof(ALLOCATORS) / sizeof(ALLOCATORS[0]); ++idx)
+         if (symbol.compare(0, std::strlen(ALLOCATORS[idx]), ALLOCATORS[idx]) == 0) return true;
+      return false;
+   }
+
+   // It returns the usable size of a block allocated by malloc
+   size_t usable_size(void *pointer) {
+#if defined(__APPLE__)
+      return malloc_size(pointer);
+#elif defined(_WIN32)
+      return _msize(pointer);
+#else
+      return malloc_usable_size(pointer);
+#endif
+   }
+}
+
+void UnitTest::Allocations::enable() {
+   Allocations::m_enabled = true;
+}
+
+bool UnitTest::Allocations::enabled() {
+   return Allocations::m_enabled;
+}
+
+UnitTest::AllocationCounters UnitTest::Allocations::counters() {
+   return t_counters;
+}
+
+UnitTest::AllocationCounters UnitTest::Allocations::measure(const std::function<void(void)> &code) {
+   AllocationCounters before = t_counters;
+   uint64_t live = Allocations::reset_peak();
+   code();
+   AllocationCounters after = t_counters;
+
+   // The peak of an enclosing measurement must include the one of code
+   t_counters.peak_bytes = std::max(before.peak_bytes, after.peak_bytes);
+
+   after.allocations -= before.allocations;
+   after.frees -= before.frees;
+   after.allocated_bytes -= before.allocated_bytes;
+   after.freed_bytes -= before.freed_bytes;
+   after.peak_bytes = (after.peak_bytes > live) ? after.peak_bytes - live : 0;
+   return after;
+}
+
+uint64_t UnitTest::Allocations::reset_peak() {
+   t_counters.peak_bytes = live_bytes();
+   return t_counters.peak_bytes;
+}
+
+void *UnitTest::Allocations::allocated(void *pointer) {
+
+   // The blocks allocated to record other blocks are not counted, so that checking leaks does
+   // not change the allocations of a UT_TEST_CASE, nor are the ones of the framework
+   if (pointer != nullptr && !t_busy && t_paused == 0) {
+      ++t_counters.allocations;
+      t_counters.allocated_bytes += usable_size(pointer);
+      t_counters.peak_bytes = std::max(t_counters.peak_bytes, live_bytes());
+      if (t_scope != 0 && Allocations::m_leaks.load(std::memory_order_relaxed)) Allocations::record(pointer);
+   }
+   return pointer;
+}
+
+void UnitTest::Allocations::freed(void *pointer) {
+   if (pointer != nullptr) Allocations::freed(pointer, usable_size(pointer));
+}
+
+void UnitTest::Allocations::freed(void *pointer, size_t size) {
+   if (pointer != nullptr && !t_busy) {
+
+      // A block recorded by a scope is forgotten even if the framework frees it
+      if (t_paused == 0) {
+         ++t_counters.frees;
+         t_counters.freed_bytes += size;
+      }
+      if (Allocations::m_leaks.load(std::memory_order_relaxed)) Allocations::forget(pointer);
+   }
+}
+
+size_t UnitTest::Allocations::size_of(void *pointer) {
+   return (pointer != nullptr) ? usable_size(pointer) : 0;
+}
+
+void UnitTest::Allocations::record(void *pointer) {
+
+   // Allocations performed while the block is recorded (e.g. by backtrace) are not recorded
+   t_busy = true;
+   Block block;
+   block.scope = t_scope;
+   block.size = usable_size(pointer);
+#if defined(UT_HAS_BACKTRACE)
+   block.depth = backtrace(block.frames, MAX_FRAMES);
+#else
+   block.depth = 0;
+#endif
+   {
+      std::lock_guard<std::mutex> lock(blocks_mutex());
+      blocks()[pointer] = block;
+   }
+   t_busy = false;
+}
+
+void UnitTest::Allocations::forget(void *pointer) {
+   t_busy = true;
+   {
+      std::lock_guard<std::mutex> lock(blocks_mutex());
+      blocks().erase(pointer);
+   }
+   t_busy = false;
+}
+
+void UnitTest::Allocations::set_leak_checking(bool enabled) {
+#if defined(UT_HAS_BACKTRACE)
+   // The first backtrace loads the unwinder, it must not happen while a block is recorded
+   void *frame = nullptr;
+   if (enabled) backtrace(&frame, 1);
+#endif
+   Allocations::m_leaks = enabled;
+}
+
+bool UnitTest::Allocations::leak_checking() {
+   return Allocations::m_leaks && Allocations::m_enabled;
+}
+
+void UnitTest::Allocations::begin_scope() {
+   t_scope = ++g_scopes;
+}
+
+std::vector<UnitTest::Leak> UnitTest::Allocations::end_scope() {
+
+   std::vector<UnitTest::Leak> leaks;
+   uint64_t scope = t_scope;
+   t_scope = 0;
+   if (scope == 0) return leaks;
+
+   // Blocks leaked from the same call stack are reported together
+   t_busy = true;
+   std::map<std::vector<void *>, Leak> stacks;
+   {
+      std::lock_guard<std::mutex> lock(blocks_mutex());
+      for (auto it = std::begin(blocks()); it != std::end(blocks()); ) {
+         if (it->second.scope != scope) {
+            ++it;
+            continue;
+         }
+         Leak &leak = stacks[std::vector<void *>(it->second.frames, it->second.frames + it->second.depth)];
+         ++leak.blocks;
+         leak.bytes += it->second.size;
+         it = blocks().erase(it);
+      }
+   }
+   t_busy = false;
+
+   // The frames of the allocation functions are skipped (the first one is always Allocations::allocated)
+   for (auto it = std::begin(stacks); it != std::end(stacks); ++it) {
+      Leak leak = it->second;
+      std::vector<std::string> symbols;
+      for (auto frame = std::begin(it->first); frame != std::end(it->first); ++frame) symbols.push_back(UnitTest::Utility::symbolize(*frame));
+      size_t first = std::min<size_t>(1, symbols.size());
+      for (size_t idx = first; idx < symbols.size() && idx < first + ALLOCATOR_FRAMES; ++idx)
+         if (is_allocator(symbols[idx])) first = idx + 1;
+      for (size_t idx = first; idx < symbols.size() && leak.stack.size() < REPORTED_FRAMES; ++idx) leak.stack.push_back(symbols[idx]);
+      leaks.push_back(leak);
+   }
+   std::sort(leaks.begin(), leaks.end(), [](const Leak &lhs, const Leak &rhs) -> bool { return lhs.bytes > rhs.bytes; });
+   return leaks;
+}
+
+UnitTest::Allocations::Pause::Pause() {
+   ++t_paused;
+}
+
+UnitTest::Allocations::Pause::~Pause() {
+   --t_paused;
+}
+
+void *UnitTest::Allocations::allocate(size_t size) {
+   return Allocations::allocated(std::malloc(size > 0 ? size : 1));
+}
+
+void UnitTest::Allocations::deallocate(void *pointer) {
+   Allocations::freed(pointer);
+   std::free(pointer);
+}
@@ -0,0 +1,371 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <new>
+
+#ifndef _UNIT_TEST_ALLOCATIONS_HPP_
+#define _UNIT_TEST_ALLOCATIONS_HPP_
+
+#if defined(__GLIBC__)
+
+// The allocator of the C library, called by the interposed allocation functions
+extern "C" {
+   void *__libc_malloc(size_t size);
+   void *__libc_calloc(size_t count, size_t size);
+   void *__libc_realloc(void *pointer, size_t size);
+   void *__libc_memalign(size_t alignment, size_t size);
+   void *__libc_valloc(size_t size);
+   void *__libc_pvalloc(size_t size);
+   void __libc_free(void *pointer);
+}
+
+// The allocation functions of the C library are interposed, operator new and delete use them
+#define UT_ALLOCATION_HOOKS() \
+   extern "C" { \
+      void *malloc(size_t size) __THROW { return UnitTest::Allocations::allocated(__libc_malloc(size)); } \
+      void *calloc(size_t count, size_t size) __THROW { return UnitTest::Allocations::allocated(__libc_calloc(count, size)); } \
+      void *realloc(void *pointer, size_t size) __THROW { \
+         /* A failed realloc leaves the block alive, it is released only on success */ \
+         size_t previous = UnitTest::Allocations::size_of(pointer); \
+         void *result = __libc_realloc(pointer, size); \
+         if (result != nullptr || size == 0) UnitTest::Allocations::freed(pointer, previous); \
+         return UnitTest::Allocations::allocated(result); \
+      } \
+      void *memalign(size_t alignment, size_t size) __THROW { return UnitTest::Allocations::allocated(__libc_memalign(alignment, size)); } \
+      void *aligned_alloc(size_t alignment, size_t size) __THROW { return UnitTest::Allocations::allocated(__libc_memalign(alignment, size)); } \
+      void *valloc(size_t size) __THROW { return UnitTest::Allocations::allocated(__libc_valloc(size)); } \
+      void *pvalloc(size_t size) __THROW { return UnitTest::Allocations::allocated(__libc_pvalloc(size)); } \
+      int posix_memalign(void **pointer, size_t alignment, size_t size) __THROW { \
+         if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) return 22; /* EINVAL */ \
+         *pointer = UnitTest::Allocations::allocated(__libc_memalign(alignment, size)); \
+         return (*pointer == nullptr && size > 0) ? 12 : 0; /* ENOMEM */ \
+      } \
+      void free(void *pointer) __THROW { UnitTest::Allocations::freed(pointer); __libc_free(pointer); } \
+   }
+
+#else
+
+// Elsewhere operator new and delete are replaced
+#define UT_ALLOCATION_HOOKS() \
+   void *operator new(std::size_t size) { \
+      void *pointer = UnitTest::Allocations::allocate(size); \
+      if (pointer == nullptr) throw std::bad_alloc(); \
+      return pointer; \
+   } \
+   void *operator new[](std::size_t size) { return operator new(size); } \
+   void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return UnitTest::Allocations::allocate(size); } \
+   void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return UnitTest::Allocations::allocate(size); } \
+   void operator delete(void *pointer) noexcept { UnitTest::Allocations::deallocate(pointer); } \
+   void operator delete[](void *pointer) noexcept { UnitTest::Allocations::deallocate(pointer); } \
+   void operator delete(void *pointer, const std::nothrow_t &) noexcept { UnitTest::Allocations::deallocate(pointer); } \
+   void operator delete[](void *pointer, const std::nothrow_t &) noexcept { UnitTest::Allocations::deallocate(pointer); } \
+   UT_SIZED_DELETE_HOOKS()
+
+#if defined(__cpp_sized_deallocation)
+#define UT_SIZED_DELETE_HOOKS() \
+   void operator delete(void *pointer, std::size_t) noexcept { UnitTest::Allocations::deallocate(pointer); } \
+   void operator delete[](void *pointer, std::size_t) noexcept { UnitTest::Allocations::deallocate(pointer); }
+#else
+#define UT_SIZED_DELETE_HOOKS()
+#endif
+
+#endif
+
+// It enables the tracking of heap allocations. It must be used once, at global scope, in a source
+// file of the tester (e.g. the one of the main): it replaces the allocation functions of the process.
+#define UT_TRACK_ALLOCATIONS() \
+   UT_ALLOCATION_HOOKS() \
+   UnitTest::AllocationTracking ut_allocation_tracking
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * The heap allocations performed by a thread. Amounts of memory are the usable sizes of the
+     * allocated blocks.
+     **/
+    struct AllocationCounters {
+
+        // The number of allocations.
+        uint64_t allocations;
+
+        // The number of deallocations.
+        uint64_t frees;
+
+        // The allocated memory, in bytes.
+        uint64_t allocated_bytes;
+
+        // The deallocated memory, in bytes.
+        uint64_t freed_bytes;
+
+        // The largest live memory (allocated minus deallocated), in bytes. Measured counters hold
+        // its growth above the live memory at the start of the measurement.
+        uint64_t peak_bytes;
+    };
+
+    /*!
+     * \brief
+     * The blocks leaked by a UT_TEST_CASE from the same call stack.
+     **/
+    struct Leak {
+
+        // The number of blocks.
+        uint64_t blocks;
+
+        // The leaked memory, in bytes.
+        uint64_t bytes;
+
+        // The symbolized call stack of the allocation, innermost call first.
+        std::vector<std::string> stack;
+    };
+
+    /*!
+     * \brief
+     * It counts the heap allocations of each thread, once UT_TRACK_ALLOCATIONS() has replaced
+     * the allocation functions of the process. Counters are thread-local, so that measuring the
+     * allocations of a UT_TEST_CASE is not disturbed by the ones executing at the same time.
+     *
+     * \notes
+     * When leaks are checked, the blocks allocated by a thread while a scope is open are recorded
+     * with their call stack until they are freed: the ones still alive when the scope is closed
+     * are the leaks of the scope.
+     **/
+    class Allocations {
+
+    private:
+
+        // It holds whether the allocation functions have been replaced.
+        static std::atomic<bool> m_enabled;
+
+        // It holds whether leaks are checked.
+        static std::atomic<bool> m_leaks;
+
+        // It records a block allocated while a scope is open.
+        static void record(void *pointer);
+
+        // It forgets a freed block.
+        static void forget(void *pointer);
+
+    public:
+
+        /*!
+         * \brief
+         * It stops counting and recording the blocks allocated by the calling thread while it is
+         * alive, it is used by the framework for its own memory (e.g. the output of a UT_TEST_CASE,
+         * the messages of failed asserts and the samples of benchmarks), so that it is not credited
+         * to the UT_TEST_CASE.
+         **/
+        class Pause {
+
+        public:
+
+            Pause();
+
+            ~Pause();
+
+            Pause(const Pause &) = delete;
+            Pause &operator=(const Pause &) = delete;
+        };
+
+        /*!
+         * \brief
+         * It records that the allocation functions have been replaced.
+         *
+         * \returns
+         * void.
+         */
+        static void enable();
+
+        /*!
+         * \brief
+         * It tells whether heap allocations are tracked.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It returns the heap allocations performed so far by the calling thread.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static AllocationCounters counters();
+
+        /*!
+         * \brief
+         * It measures the heap allocations performed by the calling thread while executing code.
+         *
+         * \param[in] code
+         * The code to be measured.
+         *
+         * \returns
+         * The allocations performed by code.
+         */
+        static AllocationCounters measure(const std::function<void(void)> &code);
+
+        /*!
+         * \brief
+         * It restarts the peak of the live memory of the calling thread from its current live memory.
+         *
+         * \returns
+         * The current live memory of the calling thread, in bytes.
+         */
+        static uint64_t reset_peak();
+
+        /*!
+         * \brief
+         * It sets whether leaks are checked.
+         *
+         * \param[in] enabled
+         * True to check leaks.
+         *
+         * \returns
+         * void.
+         */
+        static void set_leak_checking(bool enabled);
+
+        /*!
+         * \brief
+         * It tells whether leaks are checked (it requires UT_TRACK_ALLOCATIONS()).
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool leak_checking();
+
+        /*!
+         * \brief
+         * It opens a scope on the calling thread: the blocks it allocates are recorded.
+         *
+         * \returns
+         * void.
+         */
+        static void begin_scope();
+
+        /*!
+         * \brief
+         * It closes the scope of the calling thread.
+         *
+         * \returns
+         * The blocks allocated in the scope and not freed, grouped by call stack.
+         */
+        static std::vector<Leak> end_scope();
+
+        /*!
+         * \brief
+         * It records the allocation of a block.
+         *
+         * \param[in] pointer
+         * The block (nullptr when the allocation failed).
+         *
+         * \returns
+         * pointer.
+         */
+        static void *allocated(void *pointer);
+
+        /*!
+         * \brief
+         * It records the deallocation of a block.
+         *
+         * \param[in] pointer
+         * The block (nullptr is ignored).
+         *
+         * \returns
+         * void.
+         */
+        static void freed(void *pointer);
+
+        /*!
+         * \brief
+         * It records the deallocation of a block whose size has been read before releasing it
+         * (e.g. by realloc, which releases the block before returning).
+         *
+         * \param[in] pointer
+         * The block (nullptr is ignored).
+         *
+         * \param[in] size
+         * The usable size of the block, in bytes.
+         *
+         * \returns
+         * void.
+         */
+        static void freed(void *pointer, size_t size);
+
+        /*!
+         * \brief
+         * It returns the usable size of a block.
+         *
+         * \param[in] pointer
+         * The block.
+         *
+         * \returns
+         * The usable size, in bytes (0 for nullptr).
+         */
+        static size_t size_of(void *pointer);
+
+        /*!
+         * \brief
+         * It allocates a block with malloc and records it.
+         *
+         * \param[in] size
+         * The size of the block, in bytes.
+         *
+         * \returns
+         * The block, nullptr on failure.
+         */
+        static void *allocate(size_t size);
+
+        /*!
+         * \brief
+         * It records the deallocation of a block and frees it.
+         *
+         * \param[in] pointer
+         * The block.
+         *
+         * \returns
+         * void.
+         */
+        static void deallocate(void *pointer);
+    };
+
+    /*!
+     * \brief
+     * It enables the tracking of heap allocations during static initialization.
+     **/
+    struct AllocationTracking {
+        AllocationTracking() { Allocations::enable(); }
+    };
+}
+
+#endif
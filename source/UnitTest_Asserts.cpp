@@ -25,4 +25,4 @@ DEALINGS IN THE SOFTWARE.
 #include "UnitTest_Asserts.hpp"
 
 // Static member initialisation
-std::stringstream UnitTest::Asserts::ss;
+thread_local std::stringstream UnitTest::Asserts::ss;
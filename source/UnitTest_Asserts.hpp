@@ -23,7 +23,20 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
 #include "UnitTest_TestManager.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Baseline.hpp"
+#include "UnitTest_Benchmark.hpp"
+#include "UnitTest_Complexity.hpp"
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_Histogram.hpp"
+#include "UnitTest_Memory.hpp"
+#include "UnitTest_Resources.hpp"
+#include "UnitTest_Statistics.hpp"
+#include "UnitTest_Timing.hpp"
+#include "UnitTest_Utility.hpp"
 
 #ifndef _UNIT_TEST_ASSERTS_HPP_
 #define _UNIT_TEST_ASSERTS_HPP_
@@ -38,8 +51,8 @@ namespace UnitTest {
 
    private:
 
-      // It will be used to format error and messages.
-      static std::stringstream ss;
+      // It will be used to format error and messages (one per thread).
+      static thread_local std::stringstream ss;
 
    public:
 
@@ -98,6 +111,7 @@ namespace UnitTest {
       static inline void AssertEquals(TX tx, TY ty, const char *file, long line) {
         if (tx == ty) return;
         else {
+           UnitTest::Allocations::Pause pause;
            Asserts::ss << tx << " != " << ty;
            UnitTest::TestManager::display_error(UT_FUNCTION, file, line, Asserts::ss.str().c_str());
            Asserts::ss.str(std::string());
@@ -124,6 +138,7 @@ namespace UnitTest {
       static inline void AssertNotEquals(TX tx, TY ty, const char *file, long line) {
         if (tx != ty) return;
         else {
+           UnitTest::Allocations::Pause pause;
            Asserts::ss << tx << " == " << ty;
            UnitTest::TestManager::display_error(UT_FUNCTION, file, line, Asserts::ss.str().c_str());
            Asserts::ss.str(std::string());
@@ -148,6 +163,7 @@ namespace UnitTest {
 
       static inline void AssertThrows(bool ok, const char *expected, const char *found, const char *file, long line) {
         if (!ok) {
+           UnitTest::Allocations::Pause pause;
            Asserts::ss << expected << ", " << ((found != nullptr) ? found : "nothrow");
            UnitTest::TestManager::display_error(UT_FUNCTION, file, line, Asserts::ss.str().c_str());
            Asserts::ss.str(std::string());
@@ -187,6 +203,7 @@ namespace UnitTest {
 
          static inline void AssertNoThrows(bool ok, const char *thrown, const char *file, long line) {
            if (!ok) {
+              UnitTest::Allocations::Pause pause;
               Asserts::ss << "throw " << thrown;
               UnitTest::TestManager::display_error(UT_FUNCTION, file, line, Asserts::ss.str().c_str());
               Asserts::ss.str(std::string());
@@ -219,6 +236,7 @@ namespace UnitTest {
 
       static void inline AssertLessTimeThan(bool val, double req, double found, const char *filename, long line) {
         if (!val) {
+           UnitTest::Allocations::Pause pause;
            Asserts::ss << req << ", " << found;
            UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
            Asserts::ss.str("");
@@ -249,6 +267,7 @@ namespace UnitTest {
 
       static void inline AssertMoreTimeThan(bool val, double req, double found, const char *filename, long line) {
         if (!val) {
+           UnitTest::Allocations::Pause pause;
            Asserts::ss << req << ", " << found;
            UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
            Asserts::ss.str("");
@@ -276,6 +295,502 @@ namespace UnitTest {
             bool val = (elapsed > min_interval); \
             UnitTest::Asserts::AssertMoreTimeThan(val, min_interval, elapsed, UT_TEST_CASE_LOCATION);}
 
+
+      static void inline AssertLessTimeSamples(const std::vector<double> &samples, double percentile, double max,
+                                               UnitTest::Timing::Clock clock, const char *name, const char *filename, long line) {
+        UnitTest::Allocations::Pause pause;
+        UnitTest::Baseline::record(UnitTest::Statistics::median(samples) * 1e9, filename, line);
+        double found = UnitTest::Statistics::percentile(samples, percentile);
+        if (found > max) {
+           Asserts::ss << max << ", " << found << " (p" << percentile << " of " << samples.size() << " "
+                    << UnitTest::Timing::name(clock) << " samples)";
+           UnitTest::TestManager::display_error(name, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertLessTime(CLOCK, MAX_DOUBLE_INTERVAL, EXPR)
+       *
+       * \brief
+       * It establishes the maximum time span required to evaluate EXPR, measured on CLOCK. EXPR is
+       * evaluated once to warm up and then once per sample (see --timing-samples), the median of
+       * the samples is compared with MAX_DOUBLE_INTERVAL.
+       *
+       * \param CLOCK
+       * The clock: Steady (wall time), ProcessCpu, ThreadCpu or Tsc.
+       *
+       * \param MAX_DOUBLE_INTERVAL
+       * The maximum time span allowed, in seconds.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertLessTime(CLOCK, MAX_DOUBLE_INTERVAL, EXPR) \
+            UnitTest::Asserts::AssertLessTimeSamples(UnitTest::Timing::measure(UnitTest::Timing::CLOCK, [&]()->void{ EXPR; }), \
+               50.0, (double)(MAX_DOUBLE_INTERVAL), UnitTest::Timing::CLOCK, "AssertLessTime", UT_TEST_CASE_LOCATION)
+
+      /*!
+       * \def
+       * AssertLessTimePercentile(CLOCK, PERCENTILE, MAX_DOUBLE_INTERVAL, EXPR)
+       *
+       * \brief
+       * Like AssertLessTime, but the given percentile of the samples is compared with
+       * MAX_DOUBLE_INTERVAL.
+       *
+       * \param CLOCK
+       * The clock: Steady (wall time), ProcessCpu, ThreadCpu or Tsc.
+       *
+       * \param PERCENTILE
+       * The percentile of the samples to be judged, between 0 and 100.
+       *
+       * \param MAX_DOUBLE_INTERVAL
+       * The maximum time span allowed, in seconds.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertLessTimePercentile(CLOCK, PERCENTILE, MAX_DOUBLE_INTERVAL, EXPR) \
+            UnitTest::Asserts::AssertLessTimeSamples(UnitTest::Timing::measure(UnitTest::Timing::CLOCK, [&]()->void{ EXPR; }), \
+               (double)(PERCENTILE), (double)(MAX_DOUBLE_INTERVAL), UnitTest::Timing::CLOCK, "AssertLessTimePercentile", UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertMoreTime(const std::vector<double> &samples, double min,
+                                        UnitTest::Timing::Clock clock, const char *filename, long line) {
+        UnitTest::Allocations::Pause pause;
+        UnitTest::Baseline::record(UnitTest::Statistics::median(samples) * 1e9, filename, line);
+        double found = UnitTest::Statistics::median(samples);
+        if (found < min) {
+           Asserts::ss << min << ", " << found << " (median of " << samples.size() << " "
+                    << UnitTest::Timing::name(clock) << " samples)";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMoreTime(CLOCK, MIN_DOUBLE_INTERVAL, EXPR)
+       *
+       * \brief
+       * It establishes the minimum time span required to evaluate EXPR, measured on CLOCK. EXPR is
+       * evaluated once to warm up and then once per sample (see --timing-samples), the median of
+       * the samples is compared with MIN_DOUBLE_INTERVAL.
+       *
+       * \param CLOCK
+       * The clock: Steady (wall time), ProcessCpu, ThreadCpu or Tsc.
+       *
+       * \param MIN_DOUBLE_INTERVAL
+       * The minimum time span allowed, in seconds.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMoreTime(CLOCK, MIN_DOUBLE_INTERVAL, EXPR) \
+            UnitTest::Asserts::AssertMoreTime(UnitTest::Timing::measure(UnitTest::Timing::CLOCK, [&]()->void{ EXPR; }), \
+               (double)(MIN_DOUBLE_INTERVAL), UnitTest::Timing::CLOCK, UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertFasterBy(const UnitTest::ABResult &result, double percent, double confidence,
+                                        const char *filename, long line) {
+        double found = result.confidence(percent);
+        if (found < confidence) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << std::fixed << std::setprecision(1) << result.speedup() << "% faster, " << percent
+                    << "% required" << std::setprecision(3) << " (confidence " << found << " < " << confidence << ")";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+           Asserts::ss.unsetf(std::ios::floatfield);
+           Asserts::ss.precision(6);
+        }
+      }
+
+      /*!
+       * \def
+       * AssertFasterBy(AB_RESULT, PERCENT, CONFIDENCE)
+       *
+       * \brief
+       * It establishes that the candidate measured by a UT_AB_BENCHMARK is faster than the baseline
+       * by at least PERCENT percent, with the given confidence (one-sided Mann-Whitney U test).
+       *
+       * \param AB_RESULT
+       * The UnitTest::ABResult returned by UT_AB_BENCHMARK.
+       *
+       * \param PERCENT
+       * The required improvement, in percent (0 requires the candidate to be just faster).
+       *
+       * \param CONFIDENCE
+       * The required confidence, between 0 and 1 (e.g. 0.95).
+       **/
+      #define AssertFasterBy(AB_RESULT, PERCENT, CONFIDENCE) \
+            UnitTest::Asserts::AssertFasterBy(AB_RESULT, (double)(PERCENT), (double)(CONFIDENCE), UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertComplexity(const UnitTest::Complexity::Measures &measures,
+                                          UnitTest::Complexity::Class complexity, const char *filename, long line) {
+        // A single size (e.g. MIN_SIZE equal to MAX_SIZE) is fitted by every class
+        if (measures.sizes.size() < UnitTest::Complexity::MIN_FIT_SIZES) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << "at least " << UnitTest::Complexity::MIN_FIT_SIZES << " distinct input sizes are needed, "
+                    << measures.sizes.size() << " measured";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+           return;
+        }
+        std::vector<UnitTest::Complexity::Fit> fits = UnitTest::Complexity::fit(measures);
+        UnitTest::Complexity::Fit best = UnitTest::Complexity::best(fits);
+        if (best.complexity > complexity) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << UnitTest::Complexity::name(complexity) << ", " << UnitTest::Complexity::name(best.complexity)
+                    << " (best fit " << UnitTest::Complexity::describe(best) << "; "
+                    << UnitTest::Complexity::name(complexity) << " fit " << UnitTest::Complexity::describe(fits[complexity]) << ")";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertComplexity(CLASS, MIN_SIZE, MAX_SIZE, FUNCTION)
+       *
+       * \brief
+       * It establishes the asymptotic complexity of FUNCTION. FUNCTION is timed (as by
+       * AssertLessTime on the Steady clock) over a geometric range of input sizes, the measured
+       * times are fitted to the complexity classes and the class of the best fit must not be
+       * worse than CLASS.
+       *
+       * \param CLASS
+       * The complexity class: O1, OLogN, ON, ONLogN, ON2 or ON3.
+       *
+       * \param MIN_SIZE
+       * The smallest input size.
+       *
+       * \param MAX_SIZE
+       * The largest input size.
+       *
+       * \param FUNCTION
+       * A callable receiving the input size (size_t). Inputs should be prepared in advance, since
+       * everything FUNCTION does is measured.
+       **/
+      #define AssertComplexity(CLASS, MIN_SIZE, MAX_SIZE, ...) \
+            UnitTest::Asserts::AssertComplexity(UnitTest::Complexity::measure(MIN_SIZE, MAX_SIZE, __VA_ARGS__), \
+               UnitTest::Complexity::CLASS, UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertPercentileBelow(const UnitTest::Histogram &histogram, double percentile, double micros,
+                                               const char *filename, long line) {
+        double found = histogram.percentile(percentile) / 1000.0;
+        if (histogram.count() == 0 || found >= micros) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << micros << ", " << found << " (p" << percentile << " of " << histogram.count()
+                    << " values of " << histogram.name() << ", microseconds)";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertPercentileBelow(HISTOGRAM, PERCENTILE, MICROS)
+       *
+       * \brief
+       * It establishes that the given percentile of the values recorded by HISTOGRAM is lower than
+       * MICROS microseconds. An empty histogram does not satisfy it.
+       *
+       * \param HISTOGRAM
+       * A UnitTest::Histogram.
+       *
+       * \param PERCENTILE
+       * The percentile, between 0 and 100 (e.g. 99.9).
+       *
+       * \param MICROS
+       * The limit, in microseconds.
+       **/
+      #define AssertPercentileBelow(HISTOGRAM, PERCENTILE, MICROS) \
+            UnitTest::Asserts::AssertPercentileBelow(HISTOGRAM, (double)(PERCENTILE), (double)(MICROS), UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertMinRate(const UnitTest::Timing::Throughput &found, double units, double min,
+                                       const char *unit, const char *name, const char *filename, long line) {
+        UnitTest::Allocations::Pause pause;
+        UnitTest::Baseline::record(1e9 / std::max(found.per_second, 1e-9), filename, line);
+        double rate = found.per_second * units;
+        if (rate < min) {
+           Asserts::ss << min << ", " << rate << " (" << unit << " over " << found.samples << " samples, +/-"
+                    << found.error * 100.0 << "%)";
+           UnitTest::TestManager::display_error(name, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMinThroughput(OPS_PER_SEC, EXPR)
+       *
+       * \brief
+       * It establishes the minimum number of times per second EXPR can be evaluated. EXPR is
+       * evaluated in batches until the mean rate is stable (see UnitTest::Timing::throughput).
+       *
+       * \param OPS_PER_SEC
+       * The minimum number of evaluations per second.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMinThroughput(OPS_PER_SEC, EXPR) \
+            UnitTest::Asserts::AssertMinRate(UnitTest::Timing::throughput([&]()->void{ EXPR; }), \
+               1.0, (double)(OPS_PER_SEC), "ops/s", "AssertMinThroughput", UT_TEST_CASE_LOCATION)
+
+      /*!
+       * \def
+       * AssertMinBandwidth(BYTES, BYTES_PER_SEC, EXPR)
+       *
+       * \brief
+       * It establishes the minimum number of bytes per second processed by EXPR, given the
+       * number of bytes each evaluation processes. EXPR is evaluated in batches until the mean
+       * rate is stable (see UnitTest::Timing::throughput).
+       *
+       * \param BYTES
+       * The number of bytes processed by one evaluation of EXPR.
+       *
+       * \param BYTES_PER_SEC
+       * The minimum number of bytes per second.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMinBandwidth(BYTES, BYTES_PER_SEC, EXPR) \
+            UnitTest::Asserts::AssertMinRate(UnitTest::Timing::throughput([&]()->void{ EXPR; }), \
+               (double)(BYTES), (double)(BYTES_PER_SEC), "bytes/s", "AssertMinBandwidth", UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertMinEfficiency(const UnitTest::ScalingResult &result, unsigned threads, double percent,
+                                             const char *filename, long line) {
+        double found = result.efficiency(threads);
+        if (found < percent) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << std::fixed << std::setprecision(1) << percent << "%, " << found << "% (speedup "
+                    << std::setprecision(2) << result.speedup(threads) << " at " << threads << " threads)";
+           Asserts::ss.unsetf(std::ios::floatfield);
+           Asserts::ss.precision(6);
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMinEfficiency(SCALING_RESULT, THREADS, PERCENT)
+       *
+       * \brief
+       * It establishes that the parallel efficiency (speedup divided by the number of threads)
+       * measured by a UT_SCALING_BENCHMARK at THREADS threads is at least PERCENT. A number of
+       * threads that has not been measured does not satisfy it.
+       *
+       * \param SCALING_RESULT
+       * The UnitTest::ScalingResult returned by UT_SCALING_BENCHMARK.
+       *
+       * \param THREADS
+       * The number of threads.
+       *
+       * \param PERCENT
+       * The minimum efficiency, in percent.
+       **/
+      #define AssertMinEfficiency(SCALING_RESULT, THREADS, PERCENT) \
+            UnitTest::Asserts::AssertMinEfficiency(SCALING_RESULT, (unsigned)(THREADS), (double)(PERCENT), UT_TEST_CASE_LOCATION)
+
+
+      static void inline AssertAllocationsAtMost(uint64_t max, const UnitTest::AllocationCounters &found,
+                                                 const char *name, const char *filename, long line) {
+        if (!UnitTest::Allocations::enabled()) {
+           UnitTest::TestManager::display_error(name, filename, line, "allocations are not tracked, see UT_TRACK_ALLOCATIONS()");
+           return;
+        }
+        if (found.allocations > max) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << max << ", " << found.allocations << " (allocations of "
+                    << UnitTest::Utility::format_bytes(double(found.allocated_bytes)) << ")";
+           UnitTest::TestManager::display_error(name, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMaxAllocations(MAX, EXPR)
+       *
+       * \brief
+       * It establishes the maximum number of heap allocations performed by the calling thread
+       * while evaluating EXPR. It requires UT_TRACK_ALLOCATIONS().
+       *
+       * \param MAX
+       * The maximum number of allocations.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMaxAllocations(MAX, EXPR) \
+            UnitTest::Asserts::AssertAllocationsAtMost((uint64_t)(MAX), \
+               UnitTest::Allocations::measure([&]()->void{ EXPR; }), "AssertMaxAllocations", UT_TEST_CASE_LOCATION)
+
+      /*!
+       * \def
+       * AssertNoAllocations(EXPR)
+       *
+       * \brief
+       * It establishes that the calling thread performs no heap allocation while evaluating EXPR.
+       * It requires UT_TRACK_ALLOCATIONS().
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertNoAllocations(EXPR) \
+            UnitTest::Asserts::AssertAllocationsAtMost(0, UnitTest::Allocations::measure([&]()->void{ EXPR; }), \
+               "AssertNoAllocations", UT_TEST_CASE_LOCATION)
+
+      static void inline AssertMaxPeakMemory(uint64_t max, const UnitTest::MemoryUsage &found,
+                                             const char *filename, long line) {
+        // Without UT_TRACK_ALLOCATIONS() and with the resident set not measured there is nothing to check
+        if (!UnitTest::Allocations::enabled() && !found.resident_measured) {
+           UnitTest::Allocations::Pause pause;
+           CaseContext *context = UnitTest::TestManager::m_context;
+           UnitTest::TestManager::add_note(std::string(context != nullptr ? context->name : "") +
+                                           ": peak resident set not measured, peak memory not checked");
+           return;
+        }
+        uint64_t peak = UnitTest::Memory::peak(found);
+        if (peak > max) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << UnitTest::Utility::format_bytes(double(max)) << ", " << UnitTest::Utility::format_bytes(double(peak))
+                    << (UnitTest::Allocations::enabled() ? " of heap" : " of resident set");
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMaxPeakMemory(BYTES, EXPR)
+       *
+       * \brief
+       * It establishes the maximum peak memory, in bytes, used while evaluating EXPR: the peak of
+       * the live heap memory of the calling thread with UT_TRACK_ALLOCATIONS(), the growth of the
+       * peak resident set of the process otherwise.
+       *
+       * \param BYTES
+       * The maximum peak memory, in bytes.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMaxPeakMemory(BYTES, EXPR) \
+            UnitTest::Asserts::AssertMaxPeakMemory((uint64_t)(BYTES), \
+               UnitTest::Memory::measure([&]()->void{ EXPR; }), UT_TEST_CASE_LOCATION)
+
+      static void inline AssertMaxCacheMissesPerOp(double max, double operations, const UnitTest::CounterValues &found,
+                                                   const char *filename, long line) {
+        // Hosts without hardware counters do not fail the UT_TEST_CASE, the footer of the suite tells it
+        if (!found.measured || found.llc_misses < 0.0) {
+           UnitTest::Allocations::Pause pause;
+           CaseContext *context = UnitTest::TestManager::m_context;
+           UnitTest::TestManager::add_note(std::string(context != nullptr ? context->name : "") +
+                                           ": hardware counters are not available, cache misses not checked");
+           return;
+        }
+        double misses = found.per(operations).llc_misses;
+        if (misses > max) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << max << ", " << misses << " (LLC misses per operation)";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMaxCacheMissesPerOp(MAX, OPERATIONS, EXPR)
+       *
+       * \brief
+       * It establishes the maximum number of last level cache misses per operation of EXPR, that
+       * performs OPERATIONS operations. It uses the hardware counters of the calling thread and it
+       * is not checked where they are not available.
+       *
+       * \param MAX
+       * The maximum number of misses per operation.
+       *
+       * \param OPERATIONS
+       * The number of operations performed by EXPR.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMaxCacheMissesPerOp(MAX, OPERATIONS, EXPR) \
+            UnitTest::Asserts::AssertMaxCacheMissesPerOp((double)(MAX), (double)(OPERATIONS), \
+               UnitTest::Counters::measure([&]()->void{ EXPR; }), UT_TEST_CASE_LOCATION)
+
+      static void inline AssertNoMajorFaults(const UnitTest::ResourceUsage &found, const char *filename, long line) {
+        if (!found.measured) {
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, "page faults cannot be measured on this system");
+           return;
+        }
+        if (found.major_faults > 0) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << "0, " << found.major_faults << " (major faults, " << found.minor_faults << " minor faults, "
+                    << UnitTest::Utility::format_bytes(double(found.read_bytes)) << " read)";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertNoMajorFaults(EXPR)
+       *
+       * \brief
+       * It establishes that evaluating EXPR causes no major page fault (a page read from a device)
+       * on the calling thread.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertNoMajorFaults(EXPR) \
+            UnitTest::Asserts::AssertNoMajorFaults(UnitTest::Resources::measure([&]()->void{ EXPR; }), UT_TEST_CASE_LOCATION)
+
+      static void inline AssertMaxContextSwitches(uint64_t max, const UnitTest::ResourceUsage &found,
+                                                  const char *filename, long line) {
+        if (!found.measured) {
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, "context switches cannot be measured on this system");
+           return;
+        }
+        uint64_t switches = found.voluntary_switches + found.involuntary_switches;
+        if (switches > max) {
+           UnitTest::Allocations::Pause pause;
+           Asserts::ss << max << ", " << switches << " (" << found.voluntary_switches << " voluntary, "
+                    << found.involuntary_switches << " involuntary)";
+           UnitTest::TestManager::display_error(UT_FUNCTION, filename, line, Asserts::ss.str().c_str());
+           Asserts::ss.str("");
+        }
+      }
+
+      /*!
+       * \def
+       * AssertMaxContextSwitches(MAX, EXPR)
+       *
+       * \brief
+       * It establishes the maximum number of context switches (voluntary and involuntary) of the
+       * calling thread while evaluating EXPR.
+       *
+       * \param MAX
+       * The maximum number of context switches.
+       *
+       * \param EXPR
+       * The expression to be executed.
+       **/
+      #define AssertMaxContextSwitches(MAX, EXPR) \
+            UnitTest::Asserts::AssertMaxContextSwitches((uint64_t)(MAX), \
+               UnitTest::Resources::measure([&]()->void{ EXPR; }), UT_TEST_CASE_LOCATION)
+
     };
 }
 
@@ -0,0 +1,210 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+
+#include "UnitTest_Baseline.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Environment.hpp"
+#include "UnitTest_Console.hpp"
+#include "UnitTest_TestManager.hpp"
+#include "UnitTest_Timing.hpp"
+#include "UnitTest_Utility.hpp"
+
+namespace {
+
+   // The first line of a baseline file
+   const char *HEADER = "# UnitTest baseline 1";
+
+   // The prefix of the lines describing the host that produced a baseline file
+   const char *METADATA = "# ";
+
+   // The metadata that must match for results to be comparable
+   const char *COMPARABLE[] = { "cpu_model", "governor", "turbo", "compiler", "flags", "kernel" };
+
+   // It returns the key of the UT_TEST_CASE that produced a result, removing its number (#N) or
+   // the line of the timing assert that was part of the keys of older baselines (:LINE)
+   std::string case_key(const std::string &key) {
+      size_t pos = key.find_last_not_of("0123456789");
+      if (pos != std::string::npos && pos + 1 < key.size() && (key[pos] == '#' || key[pos] == ':')) return key.substr(0, pos);
+      return key;
+   }
+}
+
+// Static member initialization
+std::map<std::string, double> UnitTest::Baseline::m_reference;
+std::map<std::string, double> UnitTest::Baseline::m_results;
+std::vector<std::pair<std::string, double>> UnitTest::Baseline::m_pending;
+std::set<std::string> UnitTest::Baseline::m_executed;
+std::vector<std::string> UnitTest::Baseline::m_pending_executed;
+std::mutex UnitTest::Baseline::m_mutex;
+std::string UnitTest::Baseline::m_save_path;
+bool UnitTest::Baseline::m_compare = false;
+double UnitTest::Baseline::m_tolerance = 10.0;
+
+bool UnitTest::Baseline::read(const std::string &path, std::map<std::string, double> &results,
+                              std::map<std::string, std::string> *metadata) {
+
+   std::ifstream in(path.c_str());
+   if (!in) return false;
+
+   std::string line;
+   if (!std::getline(in, line) || line != HEADER) return false;
+
+   while (std::getline(in, line)) {
+      if (line.compare(0, 2, METADATA) == 0) {
+         size_t colon = line.find(": ");
+         if (metadata != nullptr && colon != std::string::npos) (*metadata)[line.substr(2, colon - 2)] = line.substr(colon + 2);
+         continue;
+      }
+      size_t tab = line.find('\t');
+      if (tab == std::string::npos) continue;
+      results[line.substr(0, tab)] = std::atof(line.c_str() + tab + 1);
+   }
+
+   return true;
+}
+
+bool UnitTest::Baseline::compare_with(const std::string &path) {
+   Baseline::m_compare = true;
+   Baseline::m_reference.clear();
+   std::map<std::string, std::string> metadata;
+   if (!Baseline::read(path, Baseline::m_reference, &metadata)) return false;
+
+   // Results of a different host or build are compared anyway, but not blindly
+   for (size_t idx = 0; idx < sizeof(COMPARABLE) / sizeof(COMPARABLE[0]); ++idx) {
+      auto it = metadata.find(COMPARABLE[idx]);
+      std::string current = UnitTest::Environment::metadata(COMPARABLE[idx]);
+      if (it == metadata.end() || it->second == current) continue;
+      std::string warning = "The baseline has been recorded with a different " + it->first + ": " + it->second +
+                            " (now " + current + ")\n";
+      ::Console::WriteError(warning);
+   }
+   return true;
+}
+
+void UnitTest::Baseline::save_to(const std::string &path) {
+   Baseline::m_save_path = path;
+}
+
+void UnitTest::Baseline::set_tolerance(double percent) {
+   CaseContext *context = UnitTest::TestManager::m_context;
+   if (context != nullptr) context->tolerance = std::max(percent, 0.0);
+   else Baseline::m_tolerance = std::max(percent, 0.0);
+}
+
+void UnitTest::Baseline::record(double nanoseconds, const char *file, long line) {
+
+   // Results produced out of a UT_TEST_CASE cannot be named, those disturbed by other UT_TEST_CASEs
+   // running at the same time would make the comparison fail spuriously
+   CaseContext *context = UnitTest::TestManager::m_context;
+   if (context == nullptr) return;
+   unsigned number = ++context->baseline_results;
+   if (UnitTest::Timing::disturbed()) return;
+
+   // Results outlive the UT_TEST_CASE that produced them
+   UnitTest::Allocations::Pause pause;
+   std::string key = std::string(context->suite) + "." + context->name;
+   if (number > 1) key += "#" + std::to_string(number);
+   bool found = false;
+   double reference = 0.0;
+   {
+      std::lock_guard<std::mutex> lock(Baseline::m_mutex);
+      Baseline::m_results[key] = nanoseconds;
+      if (!Baseline::m_save_path.empty()) Baseline::m_pending.push_back(std::make_pair(key, nanoseconds));
+      auto it = Baseline::m_reference.find(key);
+      found = it != Baseline::m_reference.end();
+      if (found) reference = it->second;
+   }
+
+   if (!Baseline::m_compare) return;
+   if (!found) {
+      UnitTest::TestManager::add_note(std::string(context->name) + ": " + key + " is not in the baseline, it has not been compared");
+      return;
+   }
+   if (reference <= 0.0) return;
+
+   double tolerance = (context->tolerance >= 0.0) ? context->tolerance : Baseline::m_tolerance;
+   double change = (nanoseconds - reference) / reference * 100.0;
+   if (change <= tolerance) return;
+
+   std::stringstream ss;
+   ss << UnitTest::Utility::format_time(reference) << " -> " << UnitTest::Utility::format_time(nanoseconds)
+      << std::fixed << std::setprecision(1) << " (+" << change << "% > " << tolerance << "%)";
+   UnitTest::TestManager::display_error("Baseline", file, line, ss.str().c_str());
+}
+
+void UnitTest::Baseline::record(const std::string &key, double nanoseconds) {
+   UnitTest::Allocations::Pause pause;
+   std::lock_guard<std::mutex> lock(Baseline::m_mutex);
+   Baseline::m_results[key] = nanoseconds;
+}
+
+void UnitTest::Baseline::take_pending(std::vector<std::pair<std::string, double>> &pending) {
+   std::lock_guard<std::mutex> lock(Baseline::m_mutex);
+   pending.swap(Baseline::m_pending);
+   Baseline::m_pending.clear();
+}
+
+void UnitTest::Baseline::executed(const std::string &key) {
+   if (Baseline::m_save_path.empty()) return;
+   UnitTest::Allocations::Pause pause;
+   std::lock_guard<std::mutex> lock(Baseline::m_mutex);
+   Baseline::m_executed.insert(key);
+   Baseline::m_pending_executed.push_back(key);
+}
+
+void UnitTest::Baseline::take_executed(std::vector<std::string> &pending) {
+   std::lock_guard<std::mutex> lock(Baseline::m_mutex);
+   pending.swap(Baseline::m_pending_executed);
+   Baseline::m_pending_executed.clear();
+}
+
+bool UnitTest::Baseline::save() {
+
+   if (Baseline::m_save_path.empty()) return true;
+
+   // Results of cases not executed by this run (e.g. filtered out) are kept, the executed ones
+   // replace all of their results (e.g. the ones of removed timing asserts are dropped)
+   std::map<std::string, double> results;
+   Baseline::read(Baseline::m_save_path, results);
+   for (auto it = std::begin(results); it != std::end(results); ) {
+      if (Baseline::m_executed.count(case_key(it->first)) > 0) it = results.erase(it);
+      else ++it;
+   }
+   for (auto it = std::begin(Baseline::m_results); it != std::end(Baseline::m_results); ++it) results[it->first] = it->second;
+
+   std::ofstream out(Baseline::m_save_path.c_str(), std::ios::out | std::ios::trunc);
+   if (!out) return false;
+
+   out << HEADER << std::endl << std::setprecision(10);
+   const std::vector<std::pair<std::string, std::string>> &metadata = UnitTest::Environment::metadata();
+   for (auto it = std::begin(metadata); it != std::end(metadata); ++it) out << METADATA << it->first << ": " << it->second << std::endl;
+   for (auto it = std::begin(results); it != std::end(results); ++it) out << it->first << '\t' << it->second << std::endl;
+   return static_cast<bool>(out);
+}
@@ -0,0 +1,213 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <utility>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <map>
+#include <set>
+
+#ifndef _UNIT_TEST_BASELINE_HPP_
+#define _UNIT_TEST_BASELINE_HPP_
+
+// It sets the tolerance, in percent, of the performance results of the current UT_TEST_CASE
+// when they are compared with a baseline (it overrides --baseline-tolerance).
+#define UT_BASELINE_TOLERANCE(PERCENT) UnitTest::Baseline::set_tolerance((double)(PERCENT))
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It stores the performance results of a run (the median of each UT_BENCHMARK and of each
+     * resampled timing assert) in a baseline file, and it compares the results of a later run
+     * with them: results slower than the tolerance fail the UT_TEST_CASE that produced them.
+     *
+     * \notes
+     * The baseline is a text file, each line holds a key and the median in nanoseconds, separated
+     * by a tab. The results of a UT_TEST_CASE are numbered in the order it produces them: the key
+     * of the first one is SUITE.CASE, the one of the N-th is SUITE.CASE#N, so that editing the
+     * source file does not change them.
+     * It starts with lines "# NAME: VALUE" describing the host and the build (see Environment),
+     * a baseline recorded by a different one is compared with a warning.
+     **/
+    class Baseline {
+
+    private:
+
+        // It holds the results of the reference run.
+        static std::map<std::string, double> m_reference;
+
+        // It holds the results of the current run.
+        static std::map<std::string, double> m_results;
+
+        // It holds the results recorded since the last call to take_pending.
+        static std::vector<std::pair<std::string, double>> m_pending;
+
+        // It holds the keys (SUITE.CASE) of the UT_TEST_CASEs whose results are complete.
+        static std::set<std::string> m_executed;
+
+        // It holds the keys of the UT_TEST_CASEs executed since the last call to take_executed.
+        static std::vector<std::string> m_pending_executed;
+
+        // It protects the results, they are recorded by the threads executing UT_TEST_CASEs.
+        static std::mutex m_mutex;
+
+        // The path the results are saved to (empty when they are not saved).
+        static std::string m_save_path;
+
+        // It holds whether results are compared with the reference run.
+        static bool m_compare;
+
+        // The tolerance, in percent, of the comparison.
+        static double m_tolerance;
+
+        // It reads a baseline file, and the description of the host that produced it when requested.
+        static bool read(const std::string &path, std::map<std::string, double> &results,
+                         std::map<std::string, std::string> *metadata = nullptr);
+
+    public:
+
+        /*!
+         * \brief
+         * It loads the reference results the results of the current run are compared with.
+         *
+         * \param[in] path
+         * The path of the baseline file.
+         *
+         * \returns
+         * It returns true on success, false otherwise.
+         */
+        static bool compare_with(const std::string &path);
+
+        /*!
+         * \brief
+         * It sets the path the results of the current run are saved to.
+         *
+         * \param[in] path
+         * The path of the baseline file.
+         *
+         * \returns
+         * void.
+         */
+        static void save_to(const std::string &path);
+
+        /*!
+         * \brief
+         * It sets the tolerance of the comparison: when it is called by a UT_TEST_CASE it applies
+         * to that UT_TEST_CASE only, otherwise it applies to all of them.
+         *
+         * \param[in] percent
+         * The tolerance, in percent.
+         *
+         * \returns
+         * void.
+         */
+        static void set_tolerance(double percent);
+
+        /*!
+         * \brief
+         * It records the next result of the current UT_TEST_CASE and, when a reference run has been
+         * loaded, it compares them, reporting a failure when the result is slower than tolerated
+         * and a note when the reference run has no such result.
+         *
+         * \param[in] nanoseconds
+         * The median of the result, in nanoseconds.
+         *
+         * \param[in] file
+         * The file the result has been produced in.
+         *
+         * \param[in] line
+         * The line the result has been produced at.
+         *
+         * \returns
+         * void.
+         */
+        static void record(double nanoseconds, const char *file, long line);
+
+        /*!
+         * \brief
+         * It records a result measured by another process.
+         *
+         * \param[in] key
+         * The key of the result.
+         *
+         * \param[in] nanoseconds
+         * The median of the result, in nanoseconds.
+         *
+         * \returns
+         * void.
+         */
+        static void record(const std::string &key, double nanoseconds);
+
+        /*!
+         * \brief
+         * It moves the results recorded since the previous call into pending.
+         *
+         * \param[out] pending
+         * The recorded results.
+         *
+         * \returns
+         * void.
+         */
+        static void take_pending(std::vector<std::pair<std::string, double>> &pending);
+
+        /*!
+         * \brief
+         * It records that a UT_TEST_CASE has been executed to its end, so that the results it no
+         * longer produces are removed from the baseline file.
+         *
+         * \param[in] key
+         * The key of the UT_TEST_CASE (SUITE.CASE).
+         *
+         * \returns
+         * void.
+         */
+        static void executed(const std::string &key);
+
+        /*!
+         * \brief
+         * It moves the keys of the UT_TEST_CASEs executed since the previous call into pending.
+         *
+         * \param[out] pending
+         * The keys of the executed UT_TEST_CASEs.
+         *
+         * \returns
+         * void.
+         */
+        static void take_executed(std::vector<std::string> &pending);
+
+        /*!
+         * \brief
+         * It saves the results of the current run to the file given to save_to (if any). The
+         * results of the file produced by UT_TEST_CASEs not executed by the current run are kept.
+         *
+         * \returns
+         * It returns true on success, false otherwise.
+         */
+        static bool save();
+    };
+}
+
+#endif
@@ -0,0 +1,569 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "UnitTest_Benchmark.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Baseline.hpp"
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_Environment.hpp"
+#include "UnitTest_Shared.hpp"
+#include "UnitTest_Statistics.hpp"
+#include "UnitTest_Timing.hpp"
+#include "UnitTest_Console.hpp"
+#include "UnitTest_Utility.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UT_HAS_CLFLUSH 1
+#endif
+
+unsigned UnitTest::Benchmark::m_samples = 20;
+double UnitTest::Benchmark::m_min_time = 0.01;
+double UnitTest::Benchmark::m_warmup = 0.1;
+std::string UnitTest::Benchmark::m_path;
+size_t UnitTest::Benchmark::m_eviction = 0;
+std::vector<UnitTest::BenchmarkResult> UnitTest::Benchmark::m_results;
+
+namespace {
+
+   // The largest number of iterations of a sample
+   const uint64_t MAX_ITERATIONS = 1000000000;
+
+   // The smallest number of samples of each implementation compared by a UT_AB_BENCHMARK
+   const unsigned MIN_AB_SAMPLES = 10;
+
+   // The number of rounds measured for each number of threads of a UT_SCALING_BENCHMARK
+   const unsigned SCALING_ROUNDS = 5;
+
+   // The duration, in seconds, of each round of a UT_SCALING_BENCHMARK
+   const double SCALING_ROUND_TIME = 0.05;
+
+   // The largest number of iterations of a cold sample, each of them pays for an eviction
+   const uint64_t MAX_COLD_ITERATIONS = 10;
+
+   // The size of a cache line
+   const size_t CACHE_LINE = 64;
+
+   // It returns the size, in bytes, of the last level cache (16 MiB when it is unknown)
+   size_t last_level_cache() {
+      size_t size = 0;
+#if defined(__linux__)
+      int level = 0;
+      for (int index = 0; index < 8; ++index) {
+         std::string path = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+         std::ifstream level_file((path + "level").c_str()), size_file((path + "size").c_str());
+         int current = 0;
+         std::string text;
+         if (!(level_file >> current) || !(size_file >> text) || current < level) continue;
+         size_t value = std::strtoull(text.c_str(), nullptr, 10);
+         char unit = text.empty() ? 0 : text.back();
+         if (unit == 'K') value <<= 10;
+         else if (unit == 'M') value <<= 20;
+         level = current;
+         size = value;
+      }
+#endif
+      return (size > 0) ? size : (size_t(16) << 20);
+   }
+
+   // It times the given number of calls of code, in seconds
+   double time_calls(const std::function<void(void)> &code, uint64_t calls) {
+      double start = UnitTest::Timing::now(UnitTest::Timing::Steady);
+      for (uint64_t idx = 0; idx < calls; ++idx) code();
+      return UnitTest::Timing::now(UnitTest::Timing::Steady) - start;
+   }
+}
+
+UnitTest::BenchmarkState::BenchmarkState(uint64_t iterations, bool cold) :
+   m_iterations(iterations),
+   m_remaining(iterations),
+   m_real_start(0.0),
+   m_cpu_start(0.0),
+   m_real(0.0),
+   m_cpu(0.0),
+   m_timing(false),
+   m_cold(cold) {
+}
+
+void UnitTest::BenchmarkState::start() {
+   m_timing = true;
+   m_cpu_start = UnitTest::Timing::now(UnitTest::Timing::ThreadCpu);
+   m_real_start = UnitTest::Timing::now(UnitTest::Timing::Steady);
+}
+
+void UnitTest::BenchmarkState::stop() {
+   double real = UnitTest::Timing::now(UnitTest::Timing::Steady);
+   double cpu = UnitTest::Timing::now(UnitTest::Timing::ThreadCpu);
+   m_real += real - m_real_start;
+   m_cpu += cpu - m_cpu_start;
+   m_timing = false;
+}
+
+void UnitTest::BenchmarkState::evict() {
+   if (!m_ranges.empty()) UnitTest::Benchmark::flush(m_ranges);
+   if (m_ranges.empty() || UnitTest::Benchmark::m_eviction > 0) UnitTest::Benchmark::evict_buffer();
+}
+
+void UnitTest::BenchmarkState::ColdRange(const void *data, size_t bytes) {
+   UnitTest::Allocations::Pause pause;
+   if (data != nullptr && bytes > 0) m_ranges.push_back(std::make_pair(data, bytes));
+}
+
+void UnitTest::BenchmarkState::PauseTiming() {
+   if (m_timing) stop();
+}
+
+void UnitTest::BenchmarkState::ResumeTiming() {
+   if (!m_timing && m_remaining > 0) start();
+}
+
+bool UnitTest::Benchmark::sample(BenchmarkState &state) {
+
+   m_body(state);
+
+   if (!state.completed()) {
+      UnitTest::TestManager::display_error(
+         "UT_BENCHMARK", m_entry->suite->file, m_entry->line, "the body must loop while state.KeepRunning() is true");
+      return false;
+   }
+
+   // Failed asserts stop the measurement, they would be reported once per sample otherwise
+   CaseContext *context = UnitTest::TestManager::m_context;
+   return context == nullptr || context->failures == 0;
+}
+
+void UnitTest::Benchmark::operator()() {
+
+   // The memory of the framework is not credited to the UT_BENCHMARK, only its body is measured
+   UnitTest::Environment::Isolation isolation;
+   BenchmarkResult result;
+   {
+      UnitTest::Allocations::Pause pause;
+      result.suite = m_entry->suite->name;
+      result.name = m_entry->name;
+      result.real.reserve(Benchmark::m_samples);
+      result.cpu.reserve(Benchmark::m_samples);
+   }
+
+   // The number of iterations grows until a sample lasts at least the minimum sample time
+   uint64_t iterations = 1;
+   bool cold = Benchmark::m_eviction > 0;
+   while (true) {
+      BenchmarkState state(iterations);
+      if (!this->sample(state)) return;
+      cold = cold || state.has_ranges();
+      if (state.real_time() >= Benchmark::m_min_time || iterations >= MAX_ITERATIONS) break;
+
+      double ratio = state.real_time() / Benchmark::m_min_time;
+      double factor = (ratio > 0.1) ? 1.4 / ratio : 10.0;
+      uint64_t next = static_cast<uint64_t>(iterations * factor);
+      iterations = std::min(std::max(next, iterations + 1), MAX_ITERATIONS);
+   }
+
+   // Caches, branch predictors and frequency scaling settle during the warmup, it starts once the
+   // number of iterations is known (a long calibration would leave no warmup otherwise)
+   double start = UnitTest::Timing::now(UnitTest::Timing::Steady);
+   while (UnitTest::Timing::now(UnitTest::Timing::Steady) - start < Benchmark::m_warmup) {
+      BenchmarkState state(iterations);
+      if (!this->sample(state)) return;
+   }
+
+   result.iterations = iterations;
+   bool completed = true;
+   auto samples = [&]() -> void {
+      for (unsigned idx = 0; idx < Benchmark::m_samples && completed; ++idx) {
+         BenchmarkState state(iterations);
+         completed = this->sample(state);
+         result.real.push_back(state.real_time() * 1e9 / iterations);
+         result.cpu.push_back(state.cpu_time() * 1e9 / iterations);
+      }
+   };
+   if (UnitTest::Counters::enabled()) result.counters = UnitTest::Counters::measure(samples).per(double(iterations) * Benchmark::m_samples);
+   else samples();
+   if (!completed) return;
+
+   // Cold samples have few iterations, each of them preceded by an eviction of the caches
+   if (cold) {
+      result.cold_iterations = std::min(iterations, MAX_COLD_ITERATIONS);
+      {
+         UnitTest::Allocations::Pause pause;
+         result.cold.reserve(Benchmark::m_samples);
+      }
+      for (unsigned idx = 0; idx < Benchmark::m_samples; ++idx) {
+         BenchmarkState state(result.cold_iterations, true);
+         if (!this->sample(state)) return;
+         result.cold.push_back(state.real_time() * 1e9 / result.cold_iterations);
+      }
+   }
+
+   // The result is moved to the results at last, so that its memory is released while paused
+   UnitTest::Allocations::Pause pause;
+   result.min = *std::min_element(result.real.begin(), result.real.end());
+   result.median = UnitTest::Statistics::median(result.real);
+   result.mean = UnitTest::Statistics::mean(result.real);
+   result.p99 = UnitTest::Statistics::percentile(result.real, 99.0);
+   result.stddev = UnitTest::Statistics::stddev(result.real);
+
+   std::stringstream ss;
+   if (result.cold.empty()) {
+      ss << "   " << result.real.size() << " samples x " << result.iterations << " iterations" << std::endl;
+      ss << "   min " << UnitTest::Utility::format_time(result.min) << "  median " << UnitTest::Utility::format_time(result.median)
+         << "  mean " << UnitTest::Utility::format_time(result.mean) << "  p99 " << UnitTest::Utility::format_time(result.p99)
+         << "  stddev " << UnitTest::Utility::format_time(result.stddev) << std::endl;
+   } else {
+      const std::vector<double> &samples = result.cold;
+      ss << "   " << result.real.size() << " samples x " << result.iterations << " iterations warm, "
+         << samples.size() << " samples x " << result.cold_iterations << " iterations cold" << std::endl;
+      ss << "   " << std::setw(10) << "" << std::setw(14) << "warm" << std::setw(14) << "cold" << std::endl;
+      auto row = [&](const char *label, double warm, double value) -> void {
+         ss << "   " << std::left << std::setw(10) << label << std::right << std::setw(14) << UnitTest::Utility::format_time(warm)
+            << std::setw(14) << UnitTest::Utility::format_time(value) << std::endl;
+      };
+      row("min", result.min, *std::min_element(samples.begin(), samples.end()));
+      row("median", result.median, UnitTest::Statistics::median(samples));
+      row("mean", result.mean, UnitTest::Statistics::mean(samples));
+      row("p99", result.p99, UnitTest::Statistics::percentile(samples, 99.0));
+      row("stddev", result.stddev, UnitTest::Statistics::stddev(samples));
+   }
+   if (result.counters.measured) ss << "   per iteration: " << result.counters.describe() << std::endl;
+   std::string content = ss.str();
+   ::Console::Write(content);
+
+   UnitTest::Baseline::record(result.median, m_entry->suite->file, m_entry->line);
+   Benchmark::m_results.push_back(std::move(result));
+}
+
+void UnitTest::Benchmark::set_samples(unsigned samples) {
+   Benchmark::m_samples = std::max(samples, 1u);
+}
+
+void UnitTest::Benchmark::set_min_time(double seconds) {
+   Benchmark::m_min_time = std::max(seconds, 1e-6);
+}
+
+void UnitTest::Benchmark::set_cold(double megabytes) {
+   Benchmark::m_eviction = (megabytes > 0.0) ? static_cast<size_t>(megabytes * (1 << 20)) : 2 * last_level_cache();
+}
+
+void UnitTest::Benchmark::evict_buffer() {
+
+   // The buffer is written, so that its lines replace (dirty) the ones of the benchmark
+   static std::vector<char> buffer;
+   UnitTest::Allocations::Pause pause;
+   size_t size = (Benchmark::m_eviction > 0) ? Benchmark::m_eviction : 2 * last_level_cache();
+   if (buffer.size() != size) buffer.assign(size, 0);
+   for (size_t idx = 0; idx < buffer.size(); idx += CACHE_LINE) ++buffer[idx];
+   ClobberMemory();
+}
+
+void UnitTest::Benchmark::flush(const std::vector<std::pair<const void *, size_t>> &ranges) {
+#if defined(UT_HAS_CLFLUSH)
+   for (auto it = std::begin(ranges); it != std::end(ranges); ++it) {
+      const char *begin = static_cast<const char *>(it->first);
+      for (size_t offset = 0; offset < it->second; offset += CACHE_LINE) _mm_clflush(begin + offset);
+      _mm_clflush(begin + it->second - 1);
+   }
+   _mm_mfence();
+#else
+   (void)ranges;
+   Benchmark::evict_buffer();
+#endif
+}
+
+void UnitTest::Benchmark::set_output(const std::string &path) {
+   Benchmark::m_path = path;
+}
+
+const std::vector<UnitTest::BenchmarkResult> &UnitTest::Benchmark::results() {
+   return Benchmark::m_results;
+}
+
+bool UnitTest::Benchmark::save(const char *executable) {
+
+   if (Benchmark::m_path.empty()) return true;
+
+   std::ofstream file(Benchmark::m_path.c_str(), std::ios::out | std::ios::trunc);
+   if (!file) return false;
+
+   char date[32] = {0};
+   std::time_t now = std::time(nullptr);
+   std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S+00:00", std::gmtime(&now));
+
+   char host[256] = {0};
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+   if (gethostname(host, sizeof(host) - 1) != 0) host[0] = 0;
+#endif
+
+   // The layout is the one of the JSON files written by Google Benchmark, so that its tools
+   // (e.g. compare.py) can be used on the results
+   file << std::setprecision(10);
+   file << "{" << std::endl;
+   file << "  \"context\": {" << std::endl;
+   file << "    \"date\": " << UnitTest::Utility::quote(date) << "," << std::endl;
+   file << "    \"host_name\": " << UnitTest::Utility::quote(host) << "," << std::endl;
+   file << "    \"executable\": " << UnitTest::Utility::quote(executable != nullptr ? executable : "") << "," << std::endl;
+   file << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl;
+   file << "    \"mhz_per_cpu\": 0," << std::endl;
+   std::string governor = UnitTest::Environment::metadata("governor");
+   bool scaling = governor != "unknown" && governor != "performance";
+   file << "    \"cpu_scaling_enabled\": " << (scaling ? "true" : "false") << "," << std::endl;
+   const std::vector<std::pair<std::string, std::string>> &metadata = UnitTest::Environment::metadata();
+   for (auto it = std::begin(metadata); it != std::end(metadata); ++it)
+      if (it->first != "num_cpus") file << "    " << UnitTest::Utility::quote(it->first) << ": " << UnitTest::Utility::quote(it->second) << "," << std::endl;
+   file << "    \"caches\": []," << std::endl;
+#if defined(NDEBUG)
+   file << "    \"library_build_type\": \"release\"" << std::endl;
+#else
+   file << "    \"library_build_type\": \"debug\"" << std::endl;
+#endif
+   file << "  }," << std::endl;
+   file << "  \"benchmarks\": [";
+
+   bool first = true;
+   auto write_run = [&](const BenchmarkResult &result, size_t family, const std::string &name,
+                        const char *aggregate, size_t index, uint64_t iterations, double real, double cpu) -> void {
+      file << (first ? "" : ",") << std::endl << "    {" << std::endl;
+      file << "      \"name\": " << UnitTest::Utility::quote(name) << "," << std::endl;
+      file << "      \"family_index\": " << family << "," << std::endl;
+      file << "      \"per_family_instance_index\": 0," << std::endl;
+      size_t suffix = (aggregate == nullptr) ? 0 : std::string(aggregate).size() + 1;
+      file << "      \"run_name\": " << UnitTest::Utility::quote(name.substr(0, name.size() - suffix)) << "," << std::endl;
+      file << "      \"run_type\": " << (aggregate == nullptr ? "\"iteration\"" : "\"aggregate\"") << "," << std::endl;
+      file << "      \"repetitions\": " << result.real.size() << "," << std::endl;
+      if (aggregate == nullptr) {
+         file << "      \"repetition_index\": " << index << "," << std::endl;
+      } else {
+         file << "      \"aggregate_name\": " << UnitTest::Utility::quote(aggregate) << "," << std::endl;
+         file << "      \"aggregate_unit\": \"time\"," << std::endl;
+      }
+      file << "      \"threads\": 1," << std::endl;
+      file << "      \"iterations\": " << iterations << "," << std::endl;
+      file << "      \"real_time\": " << real << "," << std::endl;
+      file << "      \"cpu_time\": " << cpu << "," << std::endl;
+      file << "      \"time_unit\": \"ns\"";
+
+      // Hardware events are written as the user counters of Google Benchmark, per iteration of the warm samples
+      const CounterValues &counters = result.counters;
+      const std::pair<const char *, double> values[] = {
+         { "cycles", counters.cycles }, { "instructions", counters.instructions }, { "branch_misses", counters.branch_misses },
+         { "l1d_misses", counters.l1d_misses }, { "llc_misses", counters.llc_misses }, { "dtlb_misses", counters.dtlb_misses }
+      };
+      bool warm = name.find("/cold") == std::string::npos;
+      for (size_t idx = 0; counters.measured && warm && idx < sizeof(values) / sizeof(values[0]); ++idx)
+         if (values[idx].second >= 0.0) file << "," << std::endl << "      " << UnitTest::Utility::quote(values[idx].first) << ": " << values[idx].second;
+      file << std::endl;
+      file << "    }";
+      first = false;
+   };
+
+   size_t family = 0;
+   for (auto it = std::begin(Benchmark::m_results); it != std::end(Benchmark::m_results); ++it, ++family) {
+      const BenchmarkResult &result = *it;
+      std::string name = result.suite + "/" + result.name;
+      for (size_t idx = 0; idx < result.real.size(); ++idx)
+         write_run(result, family, name, nullptr, idx, result.iterations, result.real[idx], result.cpu[idx]);
+
+      uint64_t samples = result.real.size();
+      write_run(result, family, name + "_mean", "mean", 0, samples, result.mean, UnitTest::Statistics::mean(result.cpu));
+      write_run(result, family, name + "_median", "median", 0, samples, result.median, UnitTest::Statistics::median(result.cpu));
+      write_run(result, family, name + "_stddev", "stddev", 0, samples, result.stddev, UnitTest::Statistics::stddev(result.cpu));
+      write_run(result, family, name + "_min", "min", 0, samples, result.min, *std::min_element(result.cpu.begin(), result.cpu.end()));
+      write_run(result, family, name + "_p99", "p99", 0, samples, result.p99, UnitTest::Statistics::percentile(result.cpu, 99.0));
+
+      // Cold samples are written as a family of their own (only wall times are measured)
+      if (result.cold.empty()) continue;
+      ++family;
+      name += "/cold";
+      const std::vector<double> &cold = result.cold;
+      for (size_t idx = 0; idx < cold.size(); ++idx)
+         write_run(result, family, name, nullptr, idx, result.cold_iterations, cold[idx], cold[idx]);
+
+      samples = cold.size();
+      double median = UnitTest::Statistics::median(cold), mean = UnitTest::Statistics::mean(cold);
+      double stddev = UnitTest::Statistics::stddev(cold), p99 = UnitTest::Statistics::percentile(cold, 99.0);
+      double min = *std::min_element(cold.begin(), cold.end());
+      write_run(result, family, name + "_mean", "mean", 0, samples, mean, mean);
+      write_run(result, family, name + "_median", "median", 0, samples, median, median);
+      write_run(result, family, name + "_stddev", "stddev", 0, samples, stddev, stddev);
+      write_run(result, family, name + "_min", "min", 0, samples, min, min);
+      write_run(result, family, name + "_p99", "p99", 0, samples, p99, p99);
+   }
+
+   file << std::endl << "  ]" << std::endl << "}" << std::endl;
+   return static_cast<bool>(file);
+}
+
+UnitTest::ABResult UnitTest::Benchmark::compare(
+   const std::function<void(void)> &baseline,
+   const std::function<void(void)> &candidate) {
+
+   UnitTest::Timing::disturbed();
+   UnitTest::Environment::Isolation isolation;
+   ABResult result;
+   unsigned samples = std::max(Benchmark::m_samples, MIN_AB_SAMPLES);
+   std::mt19937 generator;
+   {
+      UnitTest::Allocations::Pause pause;
+      generator.seed(std::random_device{}());
+      result.baseline.reserve(samples);
+      result.candidate.reserve(samples);
+   }
+
+   // The number of calls grows until a sample of the baseline lasts at least the minimum sample time
+   uint64_t calls = 1;
+   while (calls < MAX_ITERATIONS) {
+      double elapsed = time_calls(baseline, calls);
+      if (elapsed >= Benchmark::m_min_time) break;
+      double ratio = elapsed / Benchmark::m_min_time;
+      uint64_t next = static_cast<uint64_t>(calls * ((ratio > 0.1) ? 1.4 / ratio : 10.0));
+      calls = std::min(std::max(next, calls + 1), MAX_ITERATIONS);
+   }
+   time_calls(candidate, calls); // warmup of the candidate
+   result.iterations = calls;
+
+   std::bernoulli_distribution coin(0.5);
+   for (unsigned idx = 0; idx < samples; ++idx) {
+      bool baseline_first = coin(generator);
+      double first = time_calls(baseline_first ? baseline : candidate, calls);
+      double second = time_calls(baseline_first ? candidate : baseline, calls);
+      result.baseline.push_back((baseline_first ? first : second) * 1e9 / calls);
+      result.candidate.push_back((baseline_first ? second : first) * 1e9 / calls);
+   }
+
+   UnitTest::Allocations::Pause pause;
+   std::stringstream ss;
+   ss << "   A/B " << samples << " samples x " << calls << " calls: baseline "
+      << UnitTest::Utility::format_time(UnitTest::Statistics::median(result.baseline)) << ", candidate "
+      << UnitTest::Utility::format_time(UnitTest::Statistics::median(result.candidate))
+      << std::fixed << std::setprecision(1) << " (" << result.speedup() << "% faster)" << std::endl;
+   std::string content = ss.str();
+   ::Console::Write(content);
+
+   return result;
+}
+
+double UnitTest::ABResult::speedup() const {
+   double reference = UnitTest::Statistics::median(this->baseline);
+   if (reference <= 0.0) return 0.0;
+   return (1.0 - UnitTest::Statistics::median(this->candidate) / reference) * 100.0;
+}
+
+double UnitTest::ABResult::confidence(double percent) const {
+
+   // The candidate is faster by percent when its samples, slowed down by percent, are still faster
+   double factor = 1.0 - percent / 100.0;
+   if (factor <= 0.0) return 0.0;
+
+   std::vector<double> adjusted;
+   for (auto it = std::begin(this->candidate); it != std::end(this->candidate); ++it) adjusted.push_back(*it / factor);
+   return UnitTest::Statistics::mann_whitney(this->baseline, adjusted);
+}
+
+UnitTest::ScalingResult UnitTest::Benchmark::scale(unsigned max_threads, const std::function<void(unsigned)> &operation) {
+
+   // Failures of the operation are credited to the UT_TEST_CASE measuring it, while the calling
+   // thread only runs the framework
+   UnitTest::Allocations::Pause pause;
+   UnitTest::Timing::disturbed();
+   CaseContext *context = UnitTest::TestManager::m_context;
+   ScalingResult result;
+   if (max_threads == 0) max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+   std::vector<unsigned> counts;
+   for (unsigned threads = 1; threads < max_threads; threads *= 2) counts.push_back(threads);
+   counts.push_back(max_threads);
+
+   for (auto count = std::begin(counts); count != std::end(counts); ++count) {
+      std::vector<double> rounds;
+      for (unsigned round = 0; round < SCALING_ROUNDS; ++round) {
+         std::atomic<unsigned> ready(0);
+         std::atomic<bool> go(false), stop(false);
+         std::atomic<uint64_t> operations(0);
+
+         std::vector<std::thread> pool;
+         for (unsigned idx = 0; idx < *count; ++idx) {
+            pool.push_back(std::thread([&, idx]() -> void {
+               UnitTest::Environment::Isolation isolation(idx);
+               UnitTest::TestManager::set_current_case(context);
+               ++ready;
+               while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+               uint64_t done = 0;
+               try { while (!stop.load(std::memory_order_relaxed)) { operation(idx); ++done; } }
+               catch (const UnitTest::RequireFailed &) {}
+               operations += done;
+               UnitTest::TestManager::set_current_case(nullptr);
+            }));
+         }
+
+         // The barrier: every thread is running before the clock starts
+         while (ready.load() < *count) std::this_thread::yield();
+         double start = UnitTest::Timing::now(UnitTest::Timing::Steady);
+         go.store(true, std::memory_order_release);
+         std::this_thread::sleep_for(std::chrono::duration<double>(SCALING_ROUND_TIME));
+         stop.store(true);
+         for (auto it = std::begin(pool); it != std::end(pool); ++it) it->join();
+         double elapsed = UnitTest::Timing::now(UnitTest::Timing::Steady) - start;
+         rounds.push_back(operations.load() / elapsed);
+      }
+      result.threads.push_back(*count);
+      result.throughput.push_back(UnitTest::Statistics::median(rounds));
+   }
+
+   std::stringstream ss;
+   ss << "   threads         ops/s   speedup  efficiency" << std::endl;
+   for (size_t idx = 0; idx < result.threads.size(); ++idx) {
+      ss << "   " << std::setw(7) << result.threads[idx] << std::setw(14) << std::setprecision(4) << std::scientific
+         << result.throughput[idx] << std::fixed << std::setprecision(2) << std::setw(10) << result.speedup(result.threads[idx])
+         << std::setprecision(1) << std::setw(11) << result.efficiency(result.threads[idx]) << "%" << std::endl;
+   }
+   std::string content = ss.str();
+   ::Console::Write(content);
+
+   return result;
+}
+
+double UnitTest::ScalingResult::speedup(unsigned threads) const {
+   auto it = std::find(this->threads.begin(), this->threads.end(), threads);
+   if (it == this->threads.end() || this->throughput.empty() || this->throughput.front() <= 0.0) return 0.0;
+   return this->throughput[it - this->threads.begin()] / this->throughput.front();
+}
+
+double UnitTest::ScalingResult::efficiency(unsigned threads) const {
+   return (threads > 0) ? this->speedup(threads) / threads * 100.0 : 0.0;
+}
@@ -0,0 +1,565 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <functional>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <utility>
+
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_TestManager.hpp"
+
+#ifndef _UNIT_TEST_BENCHMARK_HPP_
+#define _UNIT_TEST_BENCHMARK_HPP_
+
+// UT_BENCHMARK declaration where:
+//		BENCHMARK is the name to assign to the UT_BENCHMARK
+//		__VA_ARGS__ is the list of words to use to tag the UT_BENCHMARK
+// 	NOTE: When __VA_ARGS__ is empty the comma after the name is mandatory
+//	A UT_BENCHMARK is a UT_TEST_CASE whose body receives a UnitTest::BenchmarkState named state and
+//	must loop while state.KeepRunning() returns true. It can be enabled like any other UT_TEST_CASE.
+#define UT_BENCHMARK(BENCHMARK, ...) \
+   struct BENCHMARK##_ut_case { \
+      static constexpr const char *name() { return #BENCHMARK; } \
+      static constexpr const char *tags() { return #__VA_ARGS__; } \
+      static constexpr long line() { return __LINE__; } \
+      static constexpr bool exclusive() { return true; } \
+   }; \
+   UnitTest::TestCase BENCHMARK = UnitTest::TestCase(UnitTest::CaseRegistrar<ut_suite_t, BENCHMARK##_ut_case>::get()) = \
+      UnitTest::Benchmark(UnitTest::CaseRegistrar<ut_suite_t, BENCHMARK##_ut_case>::get()) = [&](UnitTest::BenchmarkState &state)->void
+
+// It measures, interleaving their samples, a baseline and a candidate implementation (any two
+// callables taking no arguments) and it returns a UnitTest::ABResult to be checked by AssertFasterBy.
+#define UT_AB_BENCHMARK(...) UnitTest::Benchmark::compare(__VA_ARGS__)
+
+// It measures the throughput of an operation (a callable receiving the index of the calling thread)
+// executed by 1, 2, 4 ... MAX_THREADS threads and it returns a UnitTest::ScalingResult to be checked
+// by AssertMinEfficiency. When MAX_THREADS is 0 the number of hardware threads is used.
+#define UT_SCALING_BENCHMARK(MAX_THREADS, ...) UnitTest::Benchmark::scale(MAX_THREADS, __VA_ARGS__)
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It drives the iterations of a single sample of a UT_BENCHMARK and measures them.
+     **/
+    class BenchmarkState {
+
+    private:
+
+        // The number of iterations of the sample.
+        uint64_t m_iterations;
+
+        // The number of iterations still to be executed.
+        uint64_t m_remaining;
+
+        // The wall and CPU times, in seconds, when timing has been (re)started.
+        double m_real_start;
+        double m_cpu_start;
+
+        // The wall and CPU times, in seconds, measured so far.
+        double m_real;
+        double m_cpu;
+
+        // It holds whether timing is running.
+        bool m_timing;
+
+        // It holds whether caches are emptied before each iteration.
+        bool m_cold;
+
+        // The memory ranges declared by ColdRange.
+        std::vector<std::pair<const void *, size_t>> m_ranges;
+
+        // It starts timing.
+        void start();
+
+        // It stops timing and accumulates the measured times.
+        void stop();
+
+        // It empties the caches before an iteration of a cold sample.
+        void evict();
+
+    public:
+
+        explicit BenchmarkState(uint64_t iterations, bool cold = false);
+
+        /*!
+         * \brief
+         * It tells whether another iteration must be executed: the first call starts timing,
+         * the call returning false stops it.
+         *
+         * \returns
+         * See the brief description.
+         */
+        inline bool KeepRunning() {
+           if (m_remaining > 0) {
+              if (m_cold) {
+                 if (m_timing) stop();
+                 evict();
+                 start();
+              } else if (m_remaining == m_iterations) start();
+              --m_remaining;
+              return true;
+           }
+           if (m_timing) stop();
+           return false;
+        }
+
+        /*!
+         * \brief
+         * It stops timing, so that the setup of the next iteration is not measured.
+         *
+         * \returns
+         * void.
+         */
+        void PauseTiming();
+
+        /*!
+         * \brief
+         * It restarts timing after PauseTiming.
+         *
+         * \returns
+         * void.
+         */
+        void ResumeTiming();
+
+        /*!
+         * \brief
+         * It declares a memory range read or written by the body. The UT_BENCHMARK is then also
+         * measured cold: before each iteration the cache lines of the declared ranges are flushed
+         * (clflush where available, an eviction buffer otherwise) with timing stopped.
+         *
+         * \param[in] data
+         * The beginning of the range.
+         *
+         * \param[in] bytes
+         * The size of the range, in bytes.
+         *
+         * \returns
+         * void.
+         */
+        void ColdRange(const void *data, size_t bytes);
+
+        /*!
+         * \brief
+         * It tells whether caches are emptied before each iteration.
+         *
+         * \returns
+         * See the brief description.
+         */
+        bool cold() const { return m_cold; }
+
+        /*!
+         * \brief
+         * It tells whether the body declared memory ranges by ColdRange.
+         *
+         * \returns
+         * See the brief description.
+         */
+        bool has_ranges() const { return !m_ranges.empty(); }
+
+        /*!
+         * \brief
+         * It returns the number of iterations of the sample.
+         *
+         * \returns
+         * See the brief description.
+         */
+        uint64_t iterations() const { return m_iterations; }
+
+        /*!
+         * \brief
+         * It tells whether all iterations have been executed.
+         *
+         * \returns
+         * See the brief description.
+         */
+        bool completed() const { return m_remaining == 0 && !m_timing; }
+
+        /*!
+         * \brief
+         * It returns the measured wall time, in seconds.
+         *
+         * \returns
+         * See the brief description.
+         */
+        double real_time() const { return m_real; }
+
+        /*!
+         * \brief
+         * It returns the measured CPU time of the calling thread, in seconds.
+         *
+         * \returns
+         * See the brief description.
+         */
+        double cpu_time() const { return m_cpu; }
+    };
+
+    /*!
+     * \brief
+     * It holds the outcome of a UT_BENCHMARK. Times are in nanoseconds per iteration.
+     **/
+    struct BenchmarkResult {
+
+        // The name of the UT_TEST_SUITE of the UT_BENCHMARK.
+        std::string suite;
+
+        // The name of the UT_BENCHMARK.
+        std::string name;
+
+        // The number of iterations of each sample.
+        uint64_t iterations = 0;
+
+        // The wall time of each sample.
+        std::vector<double> real;
+
+        // The CPU time of each sample.
+        std::vector<double> cpu;
+
+        // Statistics of the wall time of the samples.
+        double min = 0.0;
+        double median = 0.0;
+        double mean = 0.0;
+        double p99 = 0.0;
+        double stddev = 0.0;
+
+        // The number of iterations of each cold sample (0 when it has not been measured cold).
+        uint64_t cold_iterations = 0;
+
+        // The wall time of each cold sample.
+        std::vector<double> cold;
+
+        // The hardware events counted per iteration by the samples (measured with --perf-counters).
+        CounterValues counters;
+    };
+
+    /*!
+     * \brief
+     * It holds the outcome of a UT_AB_BENCHMARK. Times are in nanoseconds per call.
+     **/
+    struct ABResult {
+
+        // The number of calls of each sample.
+        uint64_t iterations = 0;
+
+        // The time of each sample of the baseline.
+        std::vector<double> baseline;
+
+        // The time of each sample of the candidate.
+        std::vector<double> candidate;
+
+        /*!
+         * \brief
+         * It computes how much faster the candidate is than the baseline.
+         *
+         * \returns
+         * The improvement of the median, in percent (negative when the candidate is slower).
+         */
+        double speedup() const;
+
+        /*!
+         * \brief
+         * It computes the confidence with which the candidate is faster than the baseline by at
+         * least the given percentage (Mann-Whitney U test).
+         *
+         * \param[in] percent
+         * The required improvement, in percent.
+         *
+         * \returns
+         * The confidence, between 0 and 1.
+         */
+        double confidence(double percent) const;
+    };
+
+    /*!
+     * \brief
+     * It holds the outcome of a UT_SCALING_BENCHMARK.
+     **/
+    struct ScalingResult {
+
+        // The numbers of threads measured, in increasing order.
+        std::vector<unsigned> threads;
+
+        // The number of operations per second completed by all threads, for each number of threads.
+        std::vector<double> throughput;
+
+        /*!
+         * \brief
+         * It computes the speedup of the given number of threads over a single thread.
+         *
+         * \param[in] threads
+         * The number of threads.
+         *
+         * \returns
+         * The ratio of the throughputs (0 when the number of threads has not been measured).
+         */
+        double speedup(unsigned threads) const;
+
+        /*!
+         * \brief
+         * It computes the parallel efficiency of the given number of threads.
+         *
+         * \param[in] threads
+         * The number of threads.
+         *
+         * \returns
+         * The speedup divided by the number of threads, in percent (0 when the number of threads
+         * has not been measured).
+         */
+        double efficiency(unsigned threads) const;
+    };
+
+    /*!
+     * \brief
+     * It measures the body of a UT_BENCHMARK: the number of iterations of each sample is chosen
+     * so that a sample lasts at least the minimum sample time, the body is warmed up and then
+     * sampled several times. Results are written under the UT_BENCHMARK and, when requested, to
+     * a JSON file having the layout of the files written by Google Benchmark.
+     **/
+    class Benchmark {
+
+    private:
+
+        // The number of measured samples of each UT_BENCHMARK.
+        static unsigned m_samples;
+
+        // The minimum duration, in seconds, of each sample.
+        static double m_min_time;
+
+        // The duration, in seconds, of the warmup.
+        static double m_warmup;
+
+        // The path of the JSON file (empty when results are not written to a file).
+        static std::string m_path;
+
+        // The size, in bytes, of the buffer evicting the caches (0 when UT_BENCHMARKs are not
+        // measured cold unless they declare ranges).
+        static size_t m_eviction;
+
+        // The outcome of all executed UT_BENCHMARKs.
+        static std::vector<BenchmarkResult> m_results;
+
+        // The entry of the UT_BENCHMARK.
+        const CaseEntry *m_entry;
+
+        // The body of the UT_BENCHMARK.
+        std::function<void(BenchmarkState &)> m_body;
+
+        // It executes a sample of the iterations of the given state, it returns false when the body
+        // did not execute all of them.
+        bool sample(BenchmarkState &state);
+
+        // It evicts the caches writing a buffer larger than the last level cache.
+        static void evict_buffer();
+
+        // It flushes the cache lines of the given ranges, or the whole caches when they cannot
+        // be flushed one by one.
+        static void flush(const std::vector<std::pair<const void *, size_t>> &ranges);
+
+        friend class BenchmarkState;
+
+    public:
+
+        explicit Benchmark(const CaseEntry &entry) : m_entry(&entry) {}
+
+        Benchmark &operator=(std::function<void(BenchmarkState &)> body) {
+           m_body = body;
+           return *this;
+        }
+
+        /*!
+         * \brief
+         * It measures the body of the UT_BENCHMARK and reports the results.
+         *
+         * \returns
+         * void.
+         */
+        void operator()();
+
+        /*!
+         * \brief
+         * It sets the number of measured samples of each UT_BENCHMARK.
+         *
+         * \param[in] samples
+         * The number of samples.
+         *
+         * \returns
+         * void.
+         */
+        static void set_samples(unsigned samples);
+
+        /*!
+         * \brief
+         * It sets the minimum duration of each sample.
+         *
+         * \param[in] seconds
+         * The minimum duration, in seconds.
+         *
+         * \returns
+         * void.
+         */
+        static void set_min_time(double seconds);
+
+        /*!
+         * \brief
+         * It measures every UT_BENCHMARK cold too: before each iteration of a cold sample the
+         * caches are evicted writing a buffer of the given size.
+         *
+         * \param[in] megabytes
+         * The size of the eviction buffer, in megabytes (0 for twice the last level cache).
+         *
+         * \returns
+         * void.
+         */
+        static void set_cold(double megabytes);
+
+        /*!
+         * \brief
+         * It sets the path of the JSON file the results are written to.
+         *
+         * \param[in] path
+         * The path of the file.
+         *
+         * \returns
+         * void.
+         */
+        static void set_output(const std::string &path);
+
+        /*!
+         * \brief
+         * It returns the outcome of all executed UT_BENCHMARKs.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static const std::vector<BenchmarkResult> &results();
+
+        /*!
+         * \brief
+         * It writes the results to the file given to set_output (if any).
+         *
+         * \param[in] executable
+         * The name of the tester executable.
+         *
+         * \returns
+         * It returns true on success, false otherwise.
+         */
+        static bool save(const char *executable);
+
+        /*!
+         * \brief
+         * It measures a baseline and a candidate implementation. The number of calls of a sample
+         * is chosen on the baseline, then samples of the two are taken in rounds, each round in a
+         * random order, so that frequency scaling and other drifts affect both in the same way.
+         *
+         * \param[in] baseline
+         * The baseline implementation.
+         *
+         * \param[in] candidate
+         * The candidate implementation.
+         *
+         * \returns
+         * The samples of both implementations.
+         */
+        static ABResult compare(const std::function<void(void)> &baseline, const std::function<void(void)> &candidate);
+
+        /*!
+         * \brief
+         * It measures the throughput of an operation executed by a growing number of threads.
+         * For each number of threads all threads are started together by a barrier and they call
+         * the operation until they are stopped; the median throughput of several rounds is kept.
+         *
+         * \param[in] max_threads
+         * The largest number of threads (0 for the number of hardware threads).
+         *
+         * \param[in] operation
+         * The operation, it receives the index of the calling thread.
+         *
+         * \returns
+         * The throughput of each number of threads.
+         */
+        static ScalingResult scale(unsigned max_threads, const std::function<void(unsigned)> &operation);
+
+        /*!
+         * \brief
+         * It prevents the compiler from optimizing away the computation of value.
+         *
+         * \param[in] value
+         * The value.
+         *
+         * \returns
+         * void.
+         */
+        template<typename T>
+        static inline void DoNotOptimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+           asm volatile("" : : "r,m"(value) : "memory");
+#else
+           static volatile const char *sink;
+           sink = &reinterpret_cast<const volatile char &>(value);
+           std::atomic_signal_fence(std::memory_order_acq_rel);
+#endif
+        }
+
+        /*!
+         * \def
+         * DoNotOptimize(VALUE)
+         *
+         * \brief
+         * It prevents the compiler from optimizing away the computation of VALUE.
+         *
+         * \param VALUE
+         * Any expression.
+         **/
+        #define DoNotOptimize(VALUE) UnitTest::Benchmark::DoNotOptimize(VALUE)
+
+        /*!
+         * \brief
+         * It forces pending writes to memory to be performed.
+         *
+         * \returns
+         * void.
+         */
+        static inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+           asm volatile("" : : : "memory");
+#else
+           std::atomic_signal_fence(std::memory_order_acq_rel);
+#endif
+        }
+
+        /*!
+         * \def
+         * ClobberMemory()
+         *
+         * \brief
+         * It forces pending writes to memory to be performed.
+         **/
+        #define ClobberMemory() UnitTest::Benchmark::ClobberMemory()
+    };
+}
+
+#endif
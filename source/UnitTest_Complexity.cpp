@@ -0,0 +1,168 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+#include "UnitTest_Complexity.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Statistics.hpp"
+#include "UnitTest_Timing.hpp"
+
+const size_t UnitTest::Complexity::MIN_SIZES;
+const size_t UnitTest::Complexity::MIN_FIT_SIZES;
+const double UnitTest::Complexity::MIN_TIME = 1e-4;
+const double UnitTest::Complexity::MARGIN = 1.5;
+const double UnitTest::Complexity::NOISE = 0.05;
+
+namespace {
+
+   // The largest number of evaluations timed together for an input size
+   const size_t MAX_REPETITIONS = 1 << 20;
+
+   double curve(UnitTest::Complexity::Class complexity, double n) {
+      switch (complexity) {
+         case UnitTest::Complexity::O1: return 1.0;
+         case UnitTest::Complexity::OLogN: return std::log2(n);
+         case UnitTest::Complexity::ON: return n;
+         case UnitTest::Complexity::ONLogN: return n * std::log2(n);
+         case UnitTest::Complexity::ON2: return n * n;
+         case UnitTest::Complexity::ON3: return n * n * n;
+      }
+      return 1.0;
+   }
+
+   const char *term(UnitTest::Complexity::Class complexity) {
+      switch (complexity) {
+         case UnitTest::Complexity::O1: return "1";
+         case UnitTest::Complexity::OLogN: return "log N";
+         case UnitTest::Complexity::ON: return "N";
+         case UnitTest::Complexity::ONLogN: return "N log N";
+         case UnitTest::Complexity::ON2: return "N^2";
+         case UnitTest::Complexity::ON3: return "N^3";
+      }
+      return "1";
+   }
+}
+
+UnitTest::Complexity::Measures UnitTest::Complexity::measure(
+   size_t min_size,
+   size_t max_size,
+   const std::function<void(size_t)> &code) {
+
+   // Sizes grow by a factor of two, or less when it is needed to measure at least MIN_SIZES of them
+   min_size = std::max<size_t>(min_size, 2);
+   max_size = std::max(max_size, min_size);
+   double ratio = double(max_size) / min_size;
+   size_t steps = std::max<size_t>(MIN_SIZES, static_cast<size_t>(std::floor(std::log2(ratio))) + 1);
+   double factor = (ratio > 1.0) ? std::pow(ratio, 1.0 / (steps - 1)) : 1.0;
+
+   Measures measures;
+   double size = min_size;
+   for (size_t step = 0; step < steps; ++step, size *= factor) {
+      size_t n = std::min(static_cast<size_t>(std::llround(size)), max_size);
+      if (!measures.sizes.empty() && n <= measures.sizes.back()) continue;
+
+      // Evaluations are timed together until they last enough for the clock resolution
+      size_t repetitions = 1;
+      while (repetitions < MAX_REPETITIONS) {
+         double start = UnitTest::Timing::now(UnitTest::Timing::Steady);
+         for (size_t idx = 0; idx < repetitions; ++idx) code(n);
+         if (UnitTest::Timing::now(UnitTest::Timing::Steady) - start >= Complexity::MIN_TIME) break;
+         repetitions *= 2;
+      }
+
+      std::vector<double> samples = UnitTest::Timing::measure(UnitTest::Timing::Steady, [&]() -> void {
+         for (size_t idx = 0; idx < repetitions; ++idx) code(n);
+      });
+      UnitTest::Allocations::Pause pause;
+      measures.sizes.push_back(double(n));
+      measures.times.push_back(UnitTest::Statistics::median(samples) / repetitions);
+   }
+
+   return measures;
+}
+
+std::vector<UnitTest::Complexity::Fit> UnitTest::Complexity::fit(const Measures &measures) {
+
+   std::vector<Fit> fits;
+   for (int complexity = O1; complexity <= ON3; ++complexity) {
+
+      // The coefficient minimizes the sum of the squares of the relative errors
+      Fit fit = {static_cast<Class>(complexity), 0.0, 0.0};
+      double num = 0.0, den = 0.0;
+      for (size_t idx = 0; idx < measures.sizes.size(); ++idx) {
+         if (measures.times[idx] <= 0.0) continue;
+         double ratio = curve(fit.complexity, measures.sizes[idx]) / measures.times[idx];
+         num += ratio;
+         den += ratio * ratio;
+      }
+      fit.coefficient = (den > 0.0) ? num / den : 0.0;
+
+      double sum = 0.0;
+      size_t count = 0;
+      for (size_t idx = 0; idx < measures.sizes.size(); ++idx) {
+         if (measures.times[idx] <= 0.0) continue;
+         double error = (fit.coefficient * curve(fit.complexity, measures.sizes[idx]) - measures.times[idx]) / measures.times[idx];
+         sum += error * error;
+         ++count;
+      }
+      fit.rms = (count > 0) ? std::sqrt(sum / count) : 0.0;
+      fits.push_back(fit);
+   }
+
+   return fits;
+}
+
+UnitTest::Complexity::Fit UnitTest::Complexity::best(const std::vector<Fit> &fits) {
+   double lowest = std::min_element(fits.begin(), fits.end(), [](const Fit &lhs, const Fit &rhs) -> bool {
+      return lhs.rms < rhs.rms;
+   })->rms;
+
+   // Fits are in the order of the classes, from the best to the worst
+   for (auto it = std::begin(fits); it != std::end(fits); ++it)
+      if (it->rms <= std::max(lowest * Complexity::MARGIN, lowest + Complexity::NOISE)) return *it;
+   return fits.back();
+}
+
+const char *UnitTest::Complexity::name(Class complexity) {
+   switch (complexity) {
+      case O1: return "O(1)";
+      case OLogN: return "O(log N)";
+      case ON: return "O(N)";
+      case ONLogN: return "O(N log N)";
+      case ON2: return "O(N^2)";
+      case ON3: return "O(N^3)";
+   }
+   return "O(1)";
+}
+
+std::string UnitTest::Complexity::describe(const Fit &fit) {
+   std::stringstream ss;
+   ss << std::setprecision(3) << fit.coefficient << " * " << term(fit.complexity)
+      << std::fixed << std::setprecision(1) << ", rms " << fit.rms * 100.0 << "%";
+   return ss.str();
+}
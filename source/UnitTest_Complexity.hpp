@@ -0,0 +1,172 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <functional>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifndef _UNIT_TEST_COMPLEXITY_HPP_
+#define _UNIT_TEST_COMPLEXITY_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It measures code over a geometric range of input sizes and fits the measured times to
+     * asymptotic complexity classes.
+     **/
+    class Complexity {
+
+    public:
+
+        /*!
+         * \brief
+         * The complexity classes, from the best to the worst.
+         **/
+        enum Class { O1, OLogN, ON, ONLogN, ON2, ON3 };
+
+        /*!
+         * \brief
+         * It holds how well the measured times follow coefficient * f(N), f being the function
+         * of a complexity class.
+         **/
+        struct Fit {
+
+            // The complexity class.
+            Class complexity;
+
+            // The coefficient of the curve, in seconds.
+            double coefficient;
+
+            // The root mean square of the relative errors of the curve.
+            double rms;
+        };
+
+        /*!
+         * \brief
+         * It holds the times measured for each input size.
+         **/
+        struct Measures {
+
+            // The input sizes.
+            std::vector<double> sizes;
+
+            // The median time, in seconds, of an evaluation for each input size.
+            std::vector<double> times;
+        };
+
+    private:
+
+        // The smallest number of input sizes measured.
+        static const size_t MIN_SIZES = 5;
+
+        // The shortest time, in seconds, of the evaluations timed together for an input size.
+        static const double MIN_TIME;
+
+        // The factor by which the error of a worse class must be lower to be preferred to a better one.
+        static const double MARGIN;
+
+        // The error below which the curve of a class follows the measured times (they are noisy).
+        static const double NOISE;
+
+    public:
+
+        // The smallest number of distinct input sizes a fit can be made of.
+        static const size_t MIN_FIT_SIZES = 3;
+
+        /*!
+         * \brief
+         * It measures the given code over a geometric range of input sizes, timing it as the
+         * timing asserts do (see Timing::measure). Fast code is evaluated several times per
+         * sample.
+         *
+         * \param[in] min_size
+         * The smallest input size.
+         *
+         * \param[in] max_size
+         * The largest input size.
+         *
+         * \param[in] code
+         * The code to be measured, it receives the input size.
+         *
+         * \returns
+         * The measured times.
+         */
+        static Measures measure(size_t min_size, size_t max_size, const std::function<void(size_t)> &code);
+
+        /*!
+         * \brief
+         * It fits the measured times to each complexity class, minimizing the relative errors.
+         *
+         * \param[in] measures
+         * The measured times.
+         *
+         * \returns
+         * A fit for each complexity class, in the order of the classes.
+         */
+        static std::vector<Fit> fit(const Measures &measures);
+
+        /*!
+         * \brief
+         * It returns the fit of the complexity class that follows best the measured times. Noisy
+         * times often fit a worse class slightly better (e.g. N log N instead of N), so the best
+         * class is the lowest one whose error is within MARGIN times (or NOISE above) the lowest
+         * error.
+         *
+         * \param[in] fits
+         * The fits returned by fit.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static Fit best(const std::vector<Fit> &fits);
+
+        /*!
+         * \brief
+         * It returns the name of the given complexity class (e.g. O(N log N)).
+         *
+         * \param[in] complexity
+         * The complexity class.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static const char *name(Class complexity);
+
+        /*!
+         * \brief
+         * It describes the curve of the given fit (e.g. 1.2e-08 * N log N, rms 3.1%).
+         *
+         * \param[in] fit
+         * The fit.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static std::string describe(const Fit &fit);
+    };
+}
+
+#endif
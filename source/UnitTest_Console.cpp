@@ -43,6 +43,8 @@ std::map<std::string, const char *> Console::m_colours;
 
 bool Console::m_init = false;
 
+thread_local std::ostream *Console::m_stream = nullptr;
+
 #elif defined(_WIN32)
 
 #define COLOR(X) X
@@ -58,6 +60,8 @@ CONSOLE_SCREEN_BUFFER_INFO Console::csbi;
 
 bool Console::m_init = false;
 
+thread_local std::ostream *Console::m_stream = nullptr;
+
 #endif
 
 
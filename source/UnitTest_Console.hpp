@@ -26,6 +26,8 @@ DEALINGS IN THE SOFTWARE.
 #include <random>
 #include <map>
 
+#include "UnitTest_Allocations.hpp"
+
 #ifndef _UNIT_TEST_CONSOLE_HPP_
 #define _UNIT_TEST_CONSOLE_HPP_
 
@@ -46,6 +48,18 @@ private:
     // Init
     static bool m_init;
 
+    // The stream used by the calling thread (nullptr means std::cout)
+    static thread_local std::ostream *m_stream;
+
+    static std::ostream &Stream() {
+       return (Console::m_stream != nullptr) ? *Console::m_stream : std::cout;
+    }
+
+    static const char *Colour(const char *key) {
+       auto it = Console::m_colours.find(key);
+       return (it != Console::m_colours.end()) ? it->second : "";
+    }
+
     static int RandomColorIndex() {
 
        static const int min = 0;
@@ -72,41 +86,55 @@ public:
        return Console::m_init;
     }
 
+    static void SetStream(std::ostream *stream) {
+       Console::m_stream = stream;
+    }
+
     template<typename T>
     static void WriteError(T& msg) {
-       std::cout << Console::m_colours["RED"] << msg << Console::m_colours["RESET"] << std::flush;
+       UnitTest::Allocations::Pause pause; // the output outlives the UT_TEST_CASE writing it
+       Console::Stream() << Console::Colour("RED") << msg << Console::Colour("RESET") << std::flush;
        return;
     }
 
     template<typename T>
     static void Write(T& msg) {
-       std::cout << Console::m_colours["GREEN"] << msg << Console::m_colours["RESET"] << std::flush;
+       UnitTest::Allocations::Pause pause;
+       Console::Stream() << Console::Colour("GREEN") << msg << Console::Colour("RESET") << std::flush;
        return;
     }
 
     template<typename T>
     static void WriteDefault(T& msg) {
-       std::cout << Console::m_colours["RESET"] << msg << std::flush;
+       UnitTest::Allocations::Pause pause;
+       Console::Stream() << Console::Colour("RESET") << msg << std::flush;
+       return;
+    }
+
+    template<typename T>
+    static void WriteRaw(const T& msg) {
+       UnitTest::Allocations::Pause pause;
+       Console::Stream() << msg << std::flush;
        return;
     }
 
     template<typename T>
     static void WriteColor(T& msg, const char *color) {
-       if (Console::m_colours.count(color) > 0) {
-          std::cout << m_colours[color];
-       }
-       std::cout << msg << Console::m_colours["RESET"] << std::flush;
+       UnitTest::Allocations::Pause pause;
+       Console::Stream() << Console::Colour(color) << msg << Console::Colour("RESET") << std::flush;
        return;
     }
 
     template<typename T>
     static void WriteRandom(T& msg) {
-       std::cout << Console::m_colours[Console::RandomColorKey()] << msg << Console::m_colours["RESET"] << std::flush;
+       UnitTest::Allocations::Pause pause;
+       Console::Stream() << Console::Colour(Console::RandomColorKey()) << msg << Console::Colour("RESET") << std::flush;
        return;
     }
 
     static void Reset() {
-       std::cout << Console::m_colours["RESET"] << std::flush;
+       UnitTest::Allocations::Pause pause;
+       Console::Stream() << Console::Colour("RESET") << std::flush;
        return;
     }
 };
@@ -160,6 +188,9 @@ private:
    // Init
    static bool m_init;
 
+   // The stream used by the calling thread (nullptr means the console)
+   static thread_local std::ostream *m_stream;
+
 
    static enum ::Color RandomColor(){
 
@@ -214,8 +245,21 @@ public:
       ::_colors_map[::WHITE] = 0xF % 16;
    }
 
+   static void SetStream(std::ostream *stream){
+      Console::m_stream = stream;
+   }
+
+   template<typename T>
+   static void WriteRaw(const T& msg){
+      UnitTest::Allocations::Pause pause;
+      if (Console::m_stream != nullptr) (*Console::m_stream) << msg;
+      else std::cout << msg;
+   }
+
    template<typename T>
    static void WriteError(T& msg){
+      UnitTest::Allocations::Pause pause;
+      if (Console::m_stream != nullptr){ (*Console::m_stream) << msg; return; }
       SetConsoleTextAttribute(
          Console::m_standardErrHandle,
          FOREGROUND_INTENSITY | FOREGROUND_RED
@@ -226,6 +270,8 @@ public:
 
    template<typename T>
    static void Write(T& msg){
+      UnitTest::Allocations::Pause pause;
+      if (Console::m_stream != nullptr){ (*Console::m_stream) << msg; return; }
       SetConsoleTextAttribute(
          Console::m_standardOutHandle,
          FOREGROUND_INTENSITY | FOREGROUND_GREEN
@@ -236,6 +282,8 @@ public:
 
    template<typename T>
    static void WriteColor(T& msg, ::Color color){
+      UnitTest::Allocations::Pause pause;
+      if (Console::m_stream != nullptr){ (*Console::m_stream) << msg; return; }
       SetConsoleTextAttribute(
          Console::m_standardOutHandle,
          ::_colors_map[color]
@@ -246,6 +294,8 @@ public:
 
    template<typename T>
    static void WriteRandom(T& msg){
+      UnitTest::Allocations::Pause pause;
+      if (Console::m_stream != nullptr){ (*Console::m_stream) << msg; return; }
       SetConsoleTextAttribute(
          Console::m_standardOutHandle,
          ::_colors_map[Console::RandomColor()]
@@ -256,6 +306,8 @@ public:
 
    template<typename T>
    static void WriteDefault(T& msg){
+      UnitTest::Allocations::Pause pause;
+      if (Console::m_stream != nullptr){ (*Console::m_stream) << msg; return; }
       Console::Reset();
       std::cout << msg;
    }
@@ -0,0 +1,233 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_Utility.hpp"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+bool UnitTest::Counters::m_enabled = false;
+
+namespace {
+
+   // The counted events, in the order of their groups
+   enum Event { CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, DTLB_MISSES, EVENTS };
+
+   // The number of groups
+   const int GROUPS = 2;
+
+   // The value of each event (negative when it is not counted)
+   struct Reading {
+      double values[EVENTS];
+   };
+
+#if defined(__linux__)
+   // How to open each event and its group. Processors have few programmable counters: the events of
+   // a group are always counted together, so that ratios (e.g. instructions per cycle) are exact.
+   struct EventType {
+      uint32_t type;
+      uint64_t config;
+      int group;
+   };
+
+   const uint64_t READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+   const EventType EVENT_TYPES[EVENTS] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0 },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0 },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 0 },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | READ_MISS, 1 },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | READ_MISS, 1 },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | READ_MISS, 1 }
+   };
+
+   // The events opened by a thread, closed when the thread ends
+   class Groups {
+
+   private:
+
+      // The file descriptor of the leader of each group (-1 when no event of the group could be opened).
+      int m_leaders[GROUPS];
+
+      // The file descriptor of each event (-1 when it could not be opened).
+      int m_fds[EVENTS];
+
+      // The position of each event in the reading of its group.
+      int m_positions[EVENTS];
+
+      // It holds whether the events have been opened.
+      bool m_opened;
+
+   public:
+
+      Groups() : m_opened(false) {
+         for (int idx = 0; idx < GROUPS; ++idx) m_leaders[idx] = -1;
+         for (int idx = 0; idx < EVENTS; ++idx) m_fds[idx] = m_positions[idx] = -1;
+      }
+
+      ~Groups() {
+         for (int idx = 0; idx < EVENTS; ++idx) if (m_fds[idx] >= 0) close(m_fds[idx]);
+      }
+
+      Groups(const Groups &) = delete;
+      Groups &operator=(const Groups &) = delete;
+
+      // It opens the events, the first one of each group that can be opened leads it
+      bool open() {
+         if (m_opened) return available();
+         m_opened = true;
+
+         int members[GROUPS] = { 0 };
+         for (int idx = 0; idx < EVENTS; ++idx) {
+            int group = EVENT_TYPES[idx].group;
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = EVENT_TYPES[idx].type;
+            attr.config = EVENT_TYPES[idx].config;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            long fd = syscall(__NR_perf_event_open, &attr, 0, -1, m_leaders[group], 0);
+            if (fd < 0) continue;
+            m_fds[idx] = static_cast<int>(fd);
+            m_positions[idx] = members[group]++;
+            if (m_leaders[group] < 0) m_leaders[group] = m_fds[idx];
+         }
+         return available();
+      }
+
+      bool available() const {
+         return m_leaders[0] >= 0 || m_leaders[1] >= 0;
+      }
+
+      // It reads the events, together with the time each group has been enabled and running
+      void read(Reading &reading, uint64_t enabled[GROUPS], uint64_t running[GROUPS]) const {
+         for (int idx = 0; idx < EVENTS; ++idx) reading.values[idx] = -1.0;
+         for (int group = 0; group < GROUPS; ++group) {
+            enabled[group] = running[group] = 0;
+            if (m_leaders[group] < 0) continue;
+
+            // nr, time_enabled, time_running and a value per member
+            uint64_t buffer[3 + EVENTS];
+            if (::read(m_leaders[group], buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(uint64_t))) continue;
+            enabled[group] = buffer[1];
+            running[group] = buffer[2];
+            for (int idx = 0; idx < EVENTS; ++idx) {
+               if (EVENT_TYPES[idx].group == group && m_positions[idx] >= 0 && static_cast<uint64_t>(m_positions[idx]) < buffer[0])
+                  reading.values[idx] = static_cast<double>(buffer[3 + m_positions[idx]]);
+            }
+         }
+      }
+
+      int group(int event) const {
+         return EVENT_TYPES[event].group;
+      }
+   };
+
+   thread_local Groups t_groups;
+#endif
+
+   // It describes a count, or nothing when it has not been counted
+   void describe(std::stringstream &ss, double value, const char *event) {
+      if (value < 0.0) return;
+      ss << (ss.tellp() > 0 ? ", " : "") << UnitTest::Utility::format_count(value) << " " << event;
+   }
+}
+
+UnitTest::CounterValues UnitTest::CounterValues::per(double operations) const {
+   CounterValues values = *this;
+   if (operations <= 0.0) return values;
+   double *counts[] = { &values.cycles, &values.instructions, &values.branch_misses, &values.l1d_misses, &values.llc_misses, &values.dtlb_misses };
+   for (size_t idx = 0; idx < sizeof(counts) / sizeof(counts[0]); ++idx) if (*counts[idx] >= 0.0) *counts[idx] /= operations;
+   return values;
+}
+
+std::string UnitTest::CounterValues::describe() const {
+   std::stringstream ss;
+   ::describe(ss, this->cycles, "cycles");
+   ::describe(ss, this->instructions, "instructions");
+   if (this->cycles > 0.0 && this->instructions >= 0.0) ss << " (IPC " << UnitTest::Utility::format_count(this->instructions / this->cycles) << ")";
+   ::describe(ss, this->branch_misses, "branch misses");
+   ::describe(ss, this->l1d_misses, "L1D misses");
+   ::describe(ss, this->llc_misses, "LLC misses");
+   ::describe(ss, this->dtlb_misses, "dTLB misses");
+   return ss.str();
+}
+
+void UnitTest::Counters::set_enabled(bool enabled) {
+   Counters::m_enabled = enabled;
+}
+
+bool UnitTest::Counters::enabled() {
+   return Counters::m_enabled;
+}
+
+bool UnitTest::Counters::available() {
+#if defined(__linux__)
+   return t_groups.open();
+#else
+   return false;
+#endif
+}
+
+UnitTest::CounterValues UnitTest::Counters::measure(const std::function<void(void)> &code) {
+
+   CounterValues values;
+#if defined(__linux__)
+   if (!t_groups.open()) {
+      code();
+      return values;
+   }
+
+   Reading before, after;
+   uint64_t enabled_before[GROUPS], running_before[GROUPS], enabled_after[GROUPS], running_after[GROUPS];
+   t_groups.read(before, enabled_before, running_before);
+   code();
+   t_groups.read(after, enabled_after, running_after);
+
+   // Counts of multiplexed groups are scaled to the time they have been enabled
+   double *counts[EVENTS] = { &values.cycles, &values.instructions, &values.branch_misses, &values.l1d_misses, &values.llc_misses, &values.dtlb_misses };
+   for (int idx = 0; idx < EVENTS; ++idx) {
+      int group = t_groups.group(idx);
+      uint64_t running = running_after[group] - running_before[group];
+      uint64_t enabled = enabled_after[group] - enabled_before[group];
+      if (before.values[idx] < 0.0 || after.values[idx] < 0.0 || running == 0) continue;
+      *counts[idx] = (after.values[idx] - before.values[idx]) * static_cast<double>(enabled) / static_cast<double>(running);
+      values.measured = true;
+   }
+#else
+   code();
+#endif
+   return values;
+}
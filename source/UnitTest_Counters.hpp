@@ -0,0 +1,145 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <functional>
+#include <string>
+
+#ifndef _UNIT_TEST_COUNTERS_HPP_
+#define _UNIT_TEST_COUNTERS_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * The hardware events counted while executing some code. Counts are scaled when the
+     * processor had to multiplex its counters, and they are negative for events the processor
+     * does not count.
+     **/
+    struct CounterValues {
+
+        // It holds whether the events have been counted (hardware counters may not be available).
+        bool measured = false;
+
+        // The CPU cycles.
+        double cycles = -1.0;
+
+        // The retired instructions.
+        double instructions = -1.0;
+
+        // The mispredicted branches.
+        double branch_misses = -1.0;
+
+        // The reads missing the L1 data cache.
+        double l1d_misses = -1.0;
+
+        // The reads missing the last level cache.
+        double llc_misses = -1.0;
+
+        // The reads missing the data TLB.
+        double dtlb_misses = -1.0;
+
+        /*!
+         * \brief
+         * It divides the counts by a number of operations.
+         *
+         * \param[in] operations
+         * The number of operations.
+         *
+         * \returns
+         * The counts per operation.
+         */
+        CounterValues per(double operations) const;
+
+        /*!
+         * \brief
+         * It describes the counts, skipping the events that have not been counted.
+         *
+         * \returns
+         * See the brief description.
+         */
+        std::string describe() const;
+    };
+
+    /*!
+     * \brief
+     * It counts hardware events (cycles, instructions, branch misses, L1 data, last level cache
+     * and data TLB misses) of the calling thread in user space, through perf_event_open on Linux.
+     * The events are opened once per thread as two groups, each group being counted at the same
+     * time, and they are left running: measurements are differences of their readings, so that
+     * measurements can be nested. Where counters are not available (other systems, virtual
+     * machines, perf_event_paranoid) nothing is measured and nothing is reported.
+     **/
+    class Counters {
+
+    private:
+
+        // It holds whether the counters of each UT_TEST_CASE and UT_BENCHMARK are measured and reported.
+        static bool m_enabled;
+
+    public:
+
+        /*!
+         * \brief
+         * It sets whether the counters of each UT_TEST_CASE and UT_BENCHMARK are measured and reported.
+         *
+         * \param[in] enabled
+         * True to measure and report them.
+         *
+         * \returns
+         * void.
+         */
+        static void set_enabled(bool enabled);
+
+        /*!
+         * \brief
+         * It tells whether the counters of each UT_TEST_CASE and UT_BENCHMARK are measured and reported.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It tells whether hardware counters are available to the calling thread.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool available();
+
+        /*!
+         * \brief
+         * It counts the hardware events of the calling thread while executing code.
+         *
+         * \param[in] code
+         * The code to be measured.
+         *
+         * \returns
+         * The events counted (not measured when counters are not available).
+         */
+        static CounterValues measure(const std::function<void(void)> &code);
+    };
+}
+
+#endif // _UNIT_TEST_COUNTERS_HPP_
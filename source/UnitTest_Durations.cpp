@@ -0,0 +1,154 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+
+#include "UnitTest_Durations.hpp"
+
+namespace {
+
+   // The magic number and version identifying a durations file
+   const char MAGIC[4] = {'U', 'T', 'D', 'B'};
+   const uint32_t VERSION = 1;
+
+   // The weight of the latest measure in the expected duration
+   const double LATEST_WEIGHT = 0.5;
+}
+
+// Static member initialization
+std::map<std::string, double> UnitTest::Durations::m_durations;
+std::vector<std::pair<std::string, double>> UnitTest::Durations::m_pending;
+std::string UnitTest::Durations::m_path;
+
+bool UnitTest::Durations::load(const std::string &path) {
+
+   Durations::m_path = path;
+   Durations::m_durations.clear();
+
+   std::ifstream in(path.c_str(), std::ios::binary);
+   if (!in) return true; // no history yet
+
+   char magic[4];
+   uint32_t version = 0;
+   uint32_t count = 0;
+   in.read(magic, sizeof(magic));
+   in.read(reinterpret_cast<char *>(&version), sizeof(version));
+   in.read(reinterpret_cast<char *>(&count), sizeof(count));
+   if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) return false;
+
+   for (uint32_t idx = 0; idx < count; ++idx) {
+      uint16_t length = 0;
+      double seconds = 0.0;
+      in.read(reinterpret_cast<char *>(&length), sizeof(length));
+      std::string key(length, '\0');
+      if (length > 0) in.read(&key[0], length);
+      in.read(reinterpret_cast<char *>(&seconds), sizeof(seconds));
+      if (!in) {
+         Durations::m_durations.clear();
+         return false;
+      }
+      Durations::m_durations[key] = seconds;
+   }
+
+   return true;
+}
+
+bool UnitTest::Durations::save() {
+
+   if (Durations::m_path.empty()) return false;
+
+   std::ofstream out(Durations::m_path.c_str(), std::ios::binary | std::ios::trunc);
+   if (!out) return false;
+
+   uint32_t count = 0;
+   for (auto it = std::begin(Durations::m_durations); it != std::end(Durations::m_durations); ++it) {
+      if (it->first.size() <= UINT16_MAX) ++count;
+   }
+
+   out.write(MAGIC, sizeof(MAGIC));
+   out.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+   out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+
+   for (auto it = std::begin(Durations::m_durations); it != std::end(Durations::m_durations); ++it) {
+      if (it->first.size() > UINT16_MAX) continue;
+      uint16_t length = static_cast<uint16_t>(it->first.size());
+      out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+      out.write(it->first.data(), length);
+      out.write(reinterpret_cast<const char *>(&it->second), sizeof(it->second));
+   }
+
+   return static_cast<bool>(out);
+}
+
+bool UnitTest::Durations::enabled() {
+   return !Durations::m_path.empty();
+}
+
+void UnitTest::Durations::record(const std::string &key, double seconds) {
+
+   if (Durations::m_path.empty()) return;
+
+   auto it = Durations::m_durations.find(key);
+   if (it == Durations::m_durations.end()) Durations::m_durations[key] = seconds;
+   else it->second = LATEST_WEIGHT * seconds + (1.0 - LATEST_WEIGHT) * it->second;
+
+   Durations::m_pending.push_back(std::make_pair(key, seconds));
+}
+
+void UnitTest::Durations::take_pending(std::vector<std::pair<std::string, double>> &pending) {
+   pending.swap(Durations::m_pending);
+   Durations::m_pending.clear();
+}
+
+std::vector<size_t> UnitTest::Durations::longest_first(const std::vector<std::string> &keys) {
+
+   std::vector<double> costs(keys.size(), -1.0);
+   double known_total = 0.0;
+   size_t known = 0;
+
+   for (size_t idx = 0; idx < keys.size(); ++idx) {
+      auto it = Durations::m_durations.find(keys[idx]);
+      if (it == Durations::m_durations.end()) continue;
+      costs[idx] = it->second;
+      known_total += it->second;
+      ++known;
+   }
+
+   // Work without history is expected to cost as much as the average known one
+   double default_cost = (known > 0) ? known_total / known : 0.0;
+   for (auto it = std::begin(costs); it != std::end(costs); ++it) {
+      if (*it < 0.0) *it = default_cost;
+   }
+
+   std::vector<size_t> order(keys.size());
+   for (size_t idx = 0; idx < order.size(); ++idx) order[idx] = idx;
+   std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) -> bool {
+      return costs[lhs] > costs[rhs];
+   });
+
+   return order;
+}
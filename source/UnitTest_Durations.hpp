@@ -0,0 +1,137 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <utility>
+#include <string>
+#include <vector>
+#include <map>
+
+#ifndef _UNIT_TEST_DURATIONS_HPP_
+#define _UNIT_TEST_DURATIONS_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It keeps the wall time measured for UT_TEST_SUITEs and UT_TEST_CASEs across runs in a small
+     * binary file, so that the runner can start the longest work first.
+     *
+     * \notes
+     * The file begins with the "UTDB" magic, a version and the number of entries; each entry is
+     * the length of its key, the key (the name of a UT_TEST_SUITE, or SUITE.CASE for a
+     * UT_TEST_CASE) and the measured seconds. Values are stored in the native byte order.
+     **/
+    class Durations {
+
+    private:
+
+        // It holds the expected duration, in seconds, of each known UT_TEST_SUITE and UT_TEST_CASE.
+        static std::map<std::string, double> m_durations;
+
+        // It holds the durations recorded since the last call to take_pending.
+        static std::vector<std::pair<std::string, double>> m_pending;
+
+        // It holds the path of the durations file (empty when durations are not tracked).
+        static std::string m_path;
+
+    public:
+
+        /*!
+         * \brief
+         * It enables durations tracking using the file at the given path, loading its content
+         * when it exists.
+         *
+         * \param[in] path
+         * The path of the durations file.
+         *
+         * \returns
+         * It returns false when the file exists but it is not a valid durations file, true otherwise.
+         */
+        static bool load(const std::string &path);
+
+        /*!
+         * \brief
+         * It writes all known durations to the file given to load.
+         *
+         * \returns
+         * It returns true on success, false otherwise.
+         */
+        static bool save();
+
+        /*!
+         * \brief
+         * It returns whether or not durations are tracked.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It records the measured wall time of a UT_TEST_SUITE or UT_TEST_CASE. The expected
+         * duration is a running average weighted towards the most recent runs.
+         *
+         * \param[in] key
+         * The name of the UT_TEST_SUITE, or SUITE.CASE for a UT_TEST_CASE.
+         *
+         * \param[in] seconds
+         * The measured wall time.
+         *
+         * \returns
+         * void.
+         */
+        static void record(const std::string &key, double seconds);
+
+        /*!
+         * \brief
+         * It moves in the given vector the durations recorded since the last call, this is used
+         * by worker processes to send their measures to the parent process.
+         *
+         * \param[out] pending
+         * The vector to be filled.
+         *
+         * \returns
+         * void.
+         */
+        static void take_pending(std::vector<std::pair<std::string, double>> &pending);
+
+        /*!
+         * \brief
+         * It sorts the given keys from the longest to the shortest expected duration. Keys without
+         * history get the mean duration of the known ones, keys having the same expected duration
+         * keep their relative order.
+         *
+         * \param[in] keys
+         * The names of the UT_TEST_SUITEs or UT_TEST_CASEs to be scheduled.
+         *
+         * \returns
+         * The indexes of the given keys in the order they should be started.
+         */
+        static std::vector<size_t> longest_first(const std::vector<std::string> &keys);
+    };
+
+}
+
+#endif // _UNIT_TEST_DURATIONS_HPP_
@@ -0,0 +1,274 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <cerrno>
+
+#include "UnitTest_Environment.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Console.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <stdlib.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// The compilation flags of the library can be given by the build (e.g. -DUT_BUILD_FLAGS="\"-O2\"")
+#if !defined(UT_BUILD_FLAGS)
+#define UT_BUILD_FLAGS ""
+#endif
+
+std::vector<unsigned> UnitTest::Environment::m_cpus;
+bool UnitTest::Environment::m_priority = false;
+
+namespace {
+
+   // The nice value requested for the threads measuring benchmarks
+   const int RAISED_PRIORITY = -20;
+
+   // It returns the identifier of the calling thread for setpriority (0 for the whole process)
+   int thread_id() {
+#if defined(__linux__)
+      return static_cast<int>(syscall(SYS_gettid));
+#else
+      return 0;
+#endif
+   }
+
+   // It describes the compiler
+   std::string compiler() {
+#if defined(__clang__)
+      return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+      return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_FULL_VER)
+      return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+      return "unknown";
+#endif
+   }
+
+   // It describes the compilation flags, those given by the build or the ones that can be detected
+   std::string flags() {
+      std::string flags = UT_BUILD_FLAGS;
+      if (!flags.empty()) return flags;
+#if defined(__OPTIMIZE__)
+      flags += " -O";
+#endif
+#if defined(NDEBUG)
+      flags += " -DNDEBUG";
+#endif
+#if defined(__FAST_MATH__)
+      flags += " -ffast-math";
+#endif
+#if defined(__AVX512F__)
+      flags += " -mavx512f";
+#elif defined(__AVX2__)
+      flags += " -mavx2";
+#elif defined(__SSE4_2__)
+      flags += " -msse4.2";
+#endif
+#if defined(__ARM_NEON)
+      flags += " neon";
+#endif
+      return flags.empty() ? "none detected" : flags.substr(1);
+   }
+}
+
+std::string UnitTest::Environment::read_word(const std::string &path) {
+   std::ifstream in(path.c_str());
+   std::string word;
+   if (!(in >> word)) return "";
+   return word;
+}
+
+void UnitTest::Environment::set_cpus(const std::vector<unsigned> &cpus) {
+   Environment::m_cpus = cpus;
+}
+
+void UnitTest::Environment::set_priority(bool raise) {
+   Environment::m_priority = raise;
+}
+
+const std::vector<std::pair<std::string, std::string>> &UnitTest::Environment::metadata() {
+
+   // The metadata are read once, by the first UT_TEST_CASE needing them
+   UnitTest::Allocations::Pause pause;
+   static const std::vector<std::pair<std::string, std::string>> values = []() {
+      std::vector<std::pair<std::string, std::string>> values;
+      std::string model = "unknown";
+#if defined(__linux__)
+      std::ifstream cpuinfo("/proc/cpuinfo");
+      for (std::string line; std::getline(cpuinfo, line); ) {
+         if (line.compare(0, 10, "model name") != 0 && line.compare(0, 9, "Processor") != 0) continue;
+         size_t colon = line.find(':');
+         if (colon != std::string::npos && colon + 2 <= line.size()) model = line.substr(colon + 2);
+         break;
+      }
+#endif
+      values.push_back(std::make_pair("cpu_model", model));
+      values.push_back(std::make_pair("num_cpus", std::to_string(std::thread::hardware_concurrency())));
+
+      std::string governor = Environment::read_word("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+      values.push_back(std::make_pair("governor", governor.empty() ? "unknown" : governor));
+
+      std::string turbo = "unknown";
+      std::string no_turbo = Environment::read_word("/sys/devices/system/cpu/intel_pstate/no_turbo");
+      std::string boost = Environment::read_word("/sys/devices/system/cpu/cpufreq/boost");
+      if (!no_turbo.empty()) turbo = (no_turbo == "0") ? "enabled" : "disabled";
+      else if (!boost.empty()) turbo = (boost == "1") ? "enabled" : "disabled";
+      values.push_back(std::make_pair("turbo", turbo));
+
+      std::string smt = Environment::read_word("/sys/devices/system/cpu/smt/active");
+      values.push_back(std::make_pair("smt", smt.empty() ? "unknown" : (smt == "1" ? "active" : "inactive")));
+
+      values.push_back(std::make_pair("compiler", compiler()));
+      values.push_back(std::make_pair("flags", flags()));
+
+      std::string kernel = "unknown";
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+      struct utsname name;
+      if (uname(&name) == 0) kernel = std::string(name.sysname) + " " + name.release + " " + name.machine;
+#elif defined(_WIN32)
+      kernel = "Windows";
+#endif
+      values.push_back(std::make_pair("kernel", kernel));
+      return values;
+   }();
+   return values;
+}
+
+std::string UnitTest::Environment::metadata(const std::string &name) {
+   const std::vector<std::pair<std::string, std::string>> &values = Environment::metadata();
+   for (auto it = std::begin(values); it != std::end(values); ++it)
+      if (it->first == name) return it->second;
+   return "";
+}
+
+std::vector<std::string> UnitTest::Environment::warnings() {
+
+   std::vector<std::string> warnings;
+
+   std::string governor = Environment::metadata("governor");
+   if (governor != "unknown" && governor != "performance")
+      warnings.push_back("the CPU frequency scaling governor is " + governor + ", results depend on the frequency (use performance)");
+
+   if (Environment::metadata("turbo") == "enabled")
+      warnings.push_back("turbo is enabled, results depend on the temperature and on the number of busy cores");
+
+   if (Environment::metadata("smt") == "active") {
+      if (Environment::m_cpus.empty()) {
+         warnings.push_back("SMT is active, benchmarks can share a core with other threads (see --benchmark-cpus)");
+      } else {
+         for (auto it = std::begin(Environment::m_cpus); it != std::end(Environment::m_cpus); ++it) {
+            std::string siblings = Environment::read_word(
+               "/sys/devices/system/cpu/cpu" + std::to_string(*it) + "/topology/thread_siblings_list");
+            if (siblings.find_first_of(",-") != std::string::npos)
+               warnings.push_back("CPU " + std::to_string(*it) + " shares its core with its SMT siblings (" + siblings + ")");
+         }
+      }
+   }
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+   // The run itself keeps one CPU busy
+   double load[1] = {0.0};
+   if (getloadavg(load, 1) == 1 && load[0] > 1.5) {
+      std::stringstream ss;
+      ss << "the load average is " << std::fixed << std::setprecision(2) << load[0] << ", other processes are running";
+      warnings.push_back(ss.str());
+   }
+#endif
+
+   return warnings;
+}
+
+void UnitTest::Environment::check() {
+
+   UnitTest::Allocations::Pause pause;
+   static std::once_flag checked;
+   std::call_once(checked, []() {
+      std::vector<std::string> warnings = Environment::warnings();
+      for (auto it = std::begin(warnings); it != std::end(warnings); ++it) {
+         std::string content = "   warning: " + *it + "\n";
+         ::Console::WriteColor(content, COLOR(YELLOW));
+      }
+   });
+}
+
+UnitTest::Environment::Isolation::Isolation(unsigned index) :
+   m_pinned(false),
+   m_prioritized(false),
+   m_priority(0) {
+
+   Environment::check();
+
+#if defined(__linux__)
+   if (!Environment::m_cpus.empty()) {
+      cpu_set_t previous, cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(Environment::m_cpus[index % Environment::m_cpus.size()], &cpus);
+      if (sched_getaffinity(0, sizeof(previous), &previous) == 0 && sched_setaffinity(0, sizeof(cpus), &cpus) == 0) {
+         UnitTest::Allocations::Pause pause;
+         const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&previous);
+         m_affinity.assign(bytes, bytes + sizeof(previous));
+         m_pinned = true;
+      }
+   }
+#else
+   (void)index;
+#endif
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+   // Raising the priority needs privileges, without them the priority is left as it is
+   if (Environment::m_priority) {
+      errno = 0;
+      int priority = getpriority(PRIO_PROCESS, thread_id());
+      if (errno == 0 && setpriority(PRIO_PROCESS, thread_id(), RAISED_PRIORITY) == 0) {
+         m_priority = priority;
+         m_prioritized = true;
+      }
+   }
+#endif
+}
+
+UnitTest::Environment::Isolation::~Isolation() {
+#if defined(__linux__)
+   if (m_pinned) sched_setaffinity(0, sizeof(cpu_set_t), reinterpret_cast<const cpu_set_t *>(m_affinity.data()));
+#endif
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+   if (m_prioritized) setpriority(PRIO_PROCESS, thread_id(), m_priority);
+#endif
+}
@@ -0,0 +1,165 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <utility>
+#include <string>
+#include <vector>
+
+#ifndef _UNIT_TEST_ENVIRONMENT_HPP_
+#define _UNIT_TEST_ENVIRONMENT_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It reduces and reports the noise affecting benchmarks: the threads measuring them can be
+     * pinned to chosen CPUs and run at a raised priority, the settings of the host known to make
+     * results noisy are warned about, and the host is described by metadata written along with
+     * the results, so that results of different hosts are not compared blindly.
+     **/
+    class Environment {
+
+    public:
+
+        /*!
+         * \brief
+         * It isolates the calling thread while it is alive: it pins the thread to one of the
+         * chosen CPUs and it raises its priority (when allowed), both are restored afterwards.
+         **/
+        class Isolation {
+
+        private:
+
+            // It holds whether the CPU affinity of the thread has been changed.
+            bool m_pinned;
+
+            // The CPU affinity of the thread before pinning it (a cpu_set_t on Linux).
+            std::vector<unsigned char> m_affinity;
+
+            // It holds whether the priority of the thread has been changed.
+            bool m_prioritized;
+
+            // The priority of the thread before raising it.
+            int m_priority;
+
+        public:
+
+            /*!
+             * \brief
+             * It isolates the calling thread.
+             *
+             * \param[in] index
+             * The index of the thread among the ones measuring the same benchmark, the thread is
+             * pinned to the CPU having this index (modulo their number) in the chosen CPUs.
+             */
+            explicit Isolation(unsigned index = 0);
+
+            ~Isolation();
+
+            Isolation(const Isolation &) = delete;
+            Isolation &operator=(const Isolation &) = delete;
+        };
+
+    private:
+
+        // The CPUs the threads measuring benchmarks are pinned to (none when they are not pinned).
+        static std::vector<unsigned> m_cpus;
+
+        // It holds whether the priority of the threads measuring benchmarks is raised.
+        static bool m_priority;
+
+        // It reads the first word of a (system) file, it returns an empty string on failure.
+        static std::string read_word(const std::string &path);
+
+    public:
+
+        /*!
+         * \brief
+         * It sets the CPUs the threads measuring benchmarks are pinned to.
+         *
+         * \param[in] cpus
+         * The indexes of the CPUs (empty for no pinning).
+         *
+         * \returns
+         * void.
+         */
+        static void set_cpus(const std::vector<unsigned> &cpus);
+
+        /*!
+         * \brief
+         * It sets whether the priority of the threads measuring benchmarks is raised.
+         *
+         * \param[in] raise
+         * True to raise the priority.
+         *
+         * \returns
+         * void.
+         */
+        static void set_priority(bool raise);
+
+        /*!
+         * \brief
+         * It describes the host and the build: CPU model, frequency governor, turbo, SMT, load,
+         * compiler, compilation flags and kernel.
+         *
+         * \returns
+         * The pairs of names and values, computed once.
+         */
+        static const std::vector<std::pair<std::string, std::string>> &metadata();
+
+        /*!
+         * \brief
+         * It returns the value of the given metadata.
+         *
+         * \param[in] name
+         * The name of the metadata.
+         *
+         * \returns
+         * The value (an empty string when it is unknown).
+         */
+        static std::string metadata(const std::string &name);
+
+        /*!
+         * \brief
+         * It lists the settings of the host known to make benchmarks noisy: a frequency scaling
+         * governor other than performance, turbo, SMT siblings of the chosen CPUs and the load of
+         * other processes.
+         *
+         * \returns
+         * A message for each of them.
+         */
+        static std::vector<std::string> warnings();
+
+        /*!
+         * \brief
+         * It writes the warnings (see warnings) the first time it is called.
+         *
+         * \returns
+         * void.
+         */
+        static void check();
+    };
+}
+
+#endif
@@ -0,0 +1,233 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "UnitTest_Filter.hpp"
+#include <cstring>
+
+bool UnitTest::Filter::m_tags = false;
+std::vector<UnitTest::Filter::Operation> UnitTest::Filter::m_expression;
+std::vector<std::string> UnitTest::Filter::m_include;
+std::vector<std::string> UnitTest::Filter::m_exclude;
+
+namespace {
+
+   bool is_space(char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+   }
+
+   bool is_operator(char c) {
+      return c == '!' || c == '&' || c == '|' || c == ',' || c == '(' || c == ')';
+   }
+
+   void skip_spaces(const std::string &text, size_t &pos) {
+      while (pos < text.size() && is_space(text[pos])) ++pos;
+   }
+}
+
+bool UnitTest::Filter::compile_factor(const std::string &text, size_t &pos, size_t &depth, std::string &error) {
+
+   skip_spaces(text, pos);
+   if (pos == text.size()) {
+      error = "a tag is missing at the end of the tag expression";
+      return false;
+   }
+
+   if (text[pos] == '!') {
+      ++pos;
+      if (!Filter::compile_factor(text, pos, depth, error)) return false;
+      Filter::m_expression.push_back(Operation{Operation::NOT, 0});
+      return true;
+   }
+
+   if (text[pos] == '(') {
+      ++pos;
+      if (!Filter::compile_or(text, pos, depth, error)) return false;
+      skip_spaces(text, pos);
+      if (pos == text.size() || text[pos] != ')') {
+         error = "a closing parenthesis is missing in the tag expression";
+         return false;
+      }
+      ++pos;
+      return true;
+   }
+
+   size_t begin = pos;
+   while (pos < text.size() && !is_space(text[pos]) && !is_operator(text[pos])) ++pos;
+   if (pos == begin) {
+      error = std::string("unexpected '") + text[pos] + "' in the tag expression";
+      return false;
+   }
+
+   // Each operand takes a slot of the evaluation stack
+   if (++depth > Filter::MAX_DEPTH) {
+      error = "the tag expression is too long";
+      return false;
+   }
+
+   // Tags no case has been tagged with never match
+   long id = UnitTest::Registry::tag_id(text.substr(begin, pos - begin));
+   if (id < 0) Filter::m_expression.push_back(Operation{Operation::NEVER, 0});
+   else Filter::m_expression.push_back(Operation{Operation::TAG, static_cast<size_t>(id)});
+   return true;
+}
+
+bool UnitTest::Filter::compile_and(const std::string &text, size_t &pos, size_t &depth, std::string &error) {
+
+   if (!Filter::compile_factor(text, pos, depth, error)) return false;
+
+   while (true) {
+      skip_spaces(text, pos);
+      if (pos == text.size() || text[pos] != '&') return true;
+      while (pos < text.size() && text[pos] == '&') ++pos; // && is accepted as well
+      if (!Filter::compile_factor(text, pos, depth, error)) return false;
+      Filter::m_expression.push_back(Operation{Operation::AND, 0});
+      --depth;
+   }
+}
+
+bool UnitTest::Filter::compile_or(const std::string &text, size_t &pos, size_t &depth, std::string &error) {
+
+   if (!Filter::compile_and(text, pos, depth, error)) return false;
+
+   while (true) {
+      skip_spaces(text, pos);
+      if (pos == text.size() || text[pos] == ')') return true;
+      if (text[pos] == '|' || text[pos] == ',') {
+         while (pos < text.size() && (text[pos] == '|' || text[pos] == ',')) ++pos; // || is accepted as well
+      } else if (text[pos] == '&') {
+         error = "unexpected '&' in the tag expression";
+         return false;
+      }
+      // Adjacent operands are joined with |
+      if (!Filter::compile_and(text, pos, depth, error)) return false;
+      Filter::m_expression.push_back(Operation{Operation::OR, 0});
+      --depth;
+   }
+}
+
+bool UnitTest::Filter::set_tags(const std::string &expression, std::string &error) {
+
+   // An expression without tags (e.g. --tags "" or --tags ",") selects all the cases
+   Filter::m_expression.clear();
+   Filter::m_tags = expression.find_first_not_of(" \t\n\r,|") != std::string::npos;
+   if (!Filter::m_tags) return true;
+
+   size_t pos = 0;
+   size_t depth = 0;
+   if (!Filter::compile_or(expression, pos, depth, error)) return false;
+   if (pos != expression.size()) {
+      error = "unexpected ')' in the tag expression";
+      return false;
+   }
+   return true;
+}
+
+void UnitTest::Filter::add_pattern(const std::string &pattern) {
+   if (pattern.size() > 1 && pattern[0] == '~') Filter::m_exclude.push_back(pattern.substr(1));
+   else Filter::m_include.push_back(pattern);
+   return;
+}
+
+bool UnitTest::Filter::has_patterns() {
+   return !Filter::m_include.empty() || !Filter::m_exclude.empty();
+}
+
+bool UnitTest::Filter::matches_tags(const CaseEntry &entry) {
+
+   if (!Filter::m_tags) return true;
+
+   // The evaluation stack is a word, its top is the lowest bit
+   const uint64_t *bits = UnitTest::Registry::tag_bits(entry);
+   uint64_t stack = 0;
+   for (auto it = std::begin(Filter::m_expression); it != std::end(Filter::m_expression); ++it) {
+      switch (it->kind) {
+         case Operation::TAG:
+            stack = (stack << 1) | ((bits[it->tag / 64] >> (it->tag % 64)) & 1);
+            break;
+         case Operation::NEVER:
+            stack <<= 1;
+            break;
+         case Operation::NOT:
+            stack ^= 1;
+            break;
+         case Operation::AND:
+            stack = (stack >> 1) & (~uint64_t(1) | stack);
+            break;
+         case Operation::OR:
+            stack = (stack >> 1) | (stack & 1);
+            break;
+      }
+   }
+
+   return (stack & 1) != 0;
+}
+
+bool UnitTest::Filter::match(const std::string &pattern, const SuiteEntry &suite, const CaseEntry &entry) {
+
+   if (pattern.find('.') == std::string::npos)
+      return Filter::glob(pattern.c_str(), entry.name, std::strlen(entry.name));
+
+   std::string name = std::string(suite.name) + "." + entry.name;
+   return Filter::glob(pattern.c_str(), name.data(), name.size());
+}
+
+bool UnitTest::Filter::matches_name(const SuiteEntry &suite, const CaseEntry &entry) {
+
+   bool included = Filter::m_include.empty();
+   for (auto it = std::begin(Filter::m_include); !included && it != std::end(Filter::m_include); ++it) {
+      included = Filter::match(*it, suite, entry);
+   }
+   if (!included) return false;
+
+   for (auto it = std::begin(Filter::m_exclude); it != std::end(Filter::m_exclude); ++it) {
+      if (Filter::match(*it, suite, entry)) return false;
+   }
+   return true;
+}
+
+bool UnitTest::Filter::glob(const char *pattern, const char *text, size_t length) {
+
+   // On a mismatch the last * is made to match one more character
+   const char *star = nullptr;
+   size_t resume = 0;
+   size_t idx = 0;
+
+   while (idx < length) {
+      if (*pattern == '*') {
+         star = pattern++;
+         resume = idx;
+      } else if (*pattern != 0 && (*pattern == '?' || *pattern == text[idx])) {
+         ++pattern;
+         ++idx;
+      } else if (star != nullptr) {
+         pattern = star + 1;
+         idx = ++resume;
+      } else {
+         return false;
+      }
+   }
+
+   while (*pattern == '*') ++pattern;
+   return *pattern == 0;
+}
@@ -0,0 +1,184 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "UnitTest_Registry.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef _UNIT_TEST_FILTER_HPP_
+#define _UNIT_TEST_FILTER_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It selects UT_TEST_CASEs by means of a boolean expression over their tags (--tags) and of
+     * glob patterns over their names (--filter).
+     *
+     * \notes
+     * The tag expression is made of tags, ! (not), & (and), | (or) and parentheses, with the usual
+     * precedence (! binds tighter than &, which binds tighter than |). Adjacent operands and
+     * commas are joined with |, so that the former "--tags fast smoke" keeps selecting the cases
+     * tagged with any of the given tags. The expression is compiled once, in reverse polish
+     * notation over the identifiers interned by the Registry, and each case is evaluated on the
+     * bitset of its tags.
+     **/
+    class Filter {
+
+    private:
+
+        // A step of the compiled tag expression.
+        struct Operation {
+
+            // The kinds of steps.
+            enum Kind { TAG, NEVER, NOT, AND, OR };
+
+            // The kind of the step.
+            Kind kind;
+
+            // The identifier of the tag (TAG steps only).
+            size_t tag;
+        };
+
+        // The deepest expression that can be evaluated (the evaluation stack is a 64 bits word).
+        static const size_t MAX_DEPTH = 64;
+
+        // It holds whether the tag expression has been given.
+        static bool m_tags;
+
+        // It holds the compiled tag expression.
+        static std::vector<Operation> m_expression;
+
+        // It holds the patterns selecting UT_TEST_CASEs.
+        static std::vector<std::string> m_include;
+
+        // It holds the patterns excluding UT_TEST_CASEs.
+        static std::vector<std::string> m_exclude;
+
+        // It compiles an expression made of terms joined by | (or adjacency).
+        static bool compile_or(const std::string &text, size_t &pos, size_t &depth, std::string &error);
+
+        // It compiles an expression made of factors joined by &.
+        static bool compile_and(const std::string &text, size_t &pos, size_t &depth, std::string &error);
+
+        // It compiles a tag, a negation or a parenthesised expression.
+        static bool compile_factor(const std::string &text, size_t &pos, size_t &depth, std::string &error);
+
+        // It tells whether the name of the UT_TEST_CASE matches the given pattern.
+        static bool match(const std::string &pattern, const SuiteEntry &suite, const CaseEntry &entry);
+
+    public:
+
+        /*!
+         * \brief
+         * It compiles the given tag expression. The Registry must have been finalized. An empty
+         * expression, or one made only of separators, selects all the UT_TEST_CASEs.
+         *
+         * \param[in] expression
+         * The tag expression.
+         *
+         * \param[out] error
+         * The description of the error, when the expression is not valid.
+         *
+         * \returns
+         * It returns true on success, false otherwise.
+         */
+        static bool set_tags(const std::string &expression, std::string &error);
+
+        /*!
+         * \brief
+         * It adds a glob pattern (* matches any sequence of characters, ? matches any character)
+         * over the names of the UT_TEST_CASEs. Patterns containing a dot are matched against
+         * SUITE.CASE, the others against the name of the case only. Patterns starting with ~
+         * exclude the UT_TEST_CASEs they match.
+         *
+         * \param[in] pattern
+         * The pattern.
+         *
+         * \returns
+         * void.
+         */
+        static void add_pattern(const std::string &pattern);
+
+        /*!
+         * \brief
+         * It tells whether at least a pattern has been given.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool has_patterns();
+
+        /*!
+         * \brief
+         * It tells whether the tags of the given UT_TEST_CASE satisfy the tag expression (always
+         * true when no expression has been given).
+         *
+         * \param[in] entry
+         * The UT_TEST_CASE.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool matches_tags(const CaseEntry &entry);
+
+        /*!
+         * \brief
+         * It tells whether the name of the given UT_TEST_CASE is selected by the patterns: it must
+         * match one of the including patterns (if any) and none of the excluding ones.
+         *
+         * \param[in] suite
+         * The UT_TEST_SUITE of the case.
+         *
+         * \param[in] entry
+         * The UT_TEST_CASE.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool matches_name(const SuiteEntry &suite, const CaseEntry &entry);
+
+        /*!
+         * \brief
+         * It matches a text against a glob pattern (* matches any sequence of characters, ?
+         * matches any character).
+         *
+         * \param[in] pattern
+         * The pattern.
+         *
+         * \param[in] text
+         * The text.
+         *
+         * \param[in] length
+         * The length of the text.
+         *
+         * \returns
+         * It returns true when the whole text matches the pattern, false otherwise.
+         */
+        static bool glob(const char *pattern, const char *text, size_t length);
+    };
+}
+
+#endif
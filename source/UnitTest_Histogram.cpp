@@ -0,0 +1,161 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+
+#include "UnitTest_Histogram.hpp"
+#include "UnitTest_TestManager.hpp"
+#include "UnitTest_Utility.hpp"
+
+namespace {
+
+   // It returns the number of bits needed to represent value (value must not be 0)
+   unsigned bit_length(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return 64u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+      unsigned length = 0;
+      while (value != 0) {
+         value >>= 1;
+         ++length;
+      }
+      return length;
+#endif
+   }
+}
+
+UnitTest::Histogram::Histogram(const std::string &name, uint64_t highest, unsigned digits) :
+   m_name(name),
+   m_highest(std::max<uint64_t>(highest, 2)),
+   m_total(0),
+   m_min(UINT64_MAX),
+   m_max(0),
+   m_sum(0) {
+
+   // The first range must have enough counters to tell apart values differing in the last digit
+   digits = std::min(std::max(digits, 1u), 5u);
+   uint64_t largest_single_unit = 2 * static_cast<uint64_t>(std::pow(10.0, digits));
+   m_sub_bucket_magnitude = bit_length(largest_single_unit - 1);
+   m_sub_bucket_count = uint64_t(1) << m_sub_bucket_magnitude;
+   m_sub_bucket_half_count = m_sub_bucket_count / 2;
+
+   // Each further range doubles the trackable values
+   size_t buckets = 1;
+   uint64_t smallest_untrackable = m_sub_bucket_count;
+   while (smallest_untrackable <= m_highest) {
+      ++buckets;
+      if (smallest_untrackable > UINT64_MAX / 2) break;
+      smallest_untrackable <<= 1;
+   }
+
+   m_length = (buckets + 1) * m_sub_bucket_half_count;
+   m_counts.reset(new std::atomic<uint64_t>[m_length]);
+   for (size_t idx = 0; idx < m_length; ++idx) m_counts[idx].store(0, std::memory_order_relaxed);
+}
+
+UnitTest::Histogram::~Histogram() {
+   if (this->count() > 0) UnitTest::TestManager::add_note(this->summary());
+}
+
+size_t UnitTest::Histogram::index(uint64_t value) const {
+   unsigned bucket = bit_length(value | (m_sub_bucket_count - 1)) - m_sub_bucket_magnitude;
+   uint64_t sub_bucket = value >> bucket;
+   return static_cast<size_t>(((uint64_t(bucket) + 1) << (m_sub_bucket_magnitude - 1)) + (sub_bucket - m_sub_bucket_half_count));
+}
+
+uint64_t UnitTest::Histogram::highest_value(size_t index) const {
+   long bucket = static_cast<long>(index >> (m_sub_bucket_magnitude - 1)) - 1;
+   uint64_t sub_bucket = (index & (m_sub_bucket_half_count - 1)) + m_sub_bucket_half_count;
+   if (bucket < 0) {
+      sub_bucket -= m_sub_bucket_half_count;
+      bucket = 0;
+   }
+   return (sub_bucket << bucket) + (uint64_t(1) << bucket) - 1;
+}
+
+void UnitTest::Histogram::record(uint64_t nanoseconds) {
+
+   uint64_t value = std::min(nanoseconds, m_highest);
+   m_counts[this->index(value)].fetch_add(1, std::memory_order_relaxed);
+   m_sum.fetch_add(value, std::memory_order_relaxed);
+
+   uint64_t current = m_min.load(std::memory_order_relaxed);
+   while (value < current && !m_min.compare_exchange_weak(current, value, std::memory_order_relaxed));
+   current = m_max.load(std::memory_order_relaxed);
+   while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+   // The total is updated last, readers never see more values than counted
+   m_total.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t UnitTest::Histogram::percentile(double percentile) const {
+
+   uint64_t total = m_total.load(std::memory_order_acquire);
+   if (total == 0) return 0;
+
+   percentile = std::min(std::max(percentile, 0.0), 100.0);
+   uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * total)));
+   uint64_t seen = 0;
+   for (size_t idx = 0; idx < m_length; ++idx) {
+      seen += m_counts[idx].load(std::memory_order_relaxed);
+      if (seen >= target) return std::min(this->highest_value(idx), this->max());
+   }
+   return this->max();
+}
+
+uint64_t UnitTest::Histogram::count() const {
+   return m_total.load(std::memory_order_acquire);
+}
+
+uint64_t UnitTest::Histogram::min() const {
+   return (this->count() > 0) ? m_min.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t UnitTest::Histogram::max() const {
+   return m_max.load(std::memory_order_relaxed);
+}
+
+double UnitTest::Histogram::mean() const {
+   uint64_t total = this->count();
+   return (total > 0) ? double(m_sum.load(std::memory_order_relaxed)) / total : 0.0;
+}
+
+const std::string &UnitTest::Histogram::name() const {
+   return m_name;
+}
+
+std::string UnitTest::Histogram::summary() const {
+   std::stringstream ss;
+   ss << m_name << ": " << this->count() << " values"
+      << "  min " << UnitTest::Utility::format_time(double(this->min()))
+      << "  mean " << UnitTest::Utility::format_time(this->mean())
+      << "  p50 " << UnitTest::Utility::format_time(double(this->percentile(50.0)))
+      << "  p90 " << UnitTest::Utility::format_time(double(this->percentile(90.0)))
+      << "  p99 " << UnitTest::Utility::format_time(double(this->percentile(99.0)))
+      << "  p99.9 " << UnitTest::Utility::format_time(double(this->percentile(99.9)))
+      << "  max " << UnitTest::Utility::format_time(double(this->max()));
+   return ss.str();
+}
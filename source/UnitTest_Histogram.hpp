@@ -0,0 +1,207 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#ifndef _UNIT_TEST_HISTOGRAM_HPP_
+#define _UNIT_TEST_HISTOGRAM_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * A High Dynamic Range histogram of latencies, in nanoseconds. Values are recorded without
+     * locks, so that many threads can feed the same histogram, keeping the given number of
+     * significant decimal digits: the counters of each power of two range are linear.
+     *
+     * \notes
+     * When it is destroyed its summary (count, minimum, percentiles and maximum) is written in
+     * the footer of the UT_TEST_SUITE. Values greater than the highest trackable value are
+     * recorded as the highest trackable value.
+     **/
+    class Histogram {
+
+    private:
+
+        // The name written in the summary.
+        std::string m_name;
+
+        // The highest trackable value.
+        uint64_t m_highest;
+
+        // The number of counters of the first power of two range, and its logarithm.
+        uint64_t m_sub_bucket_count;
+        unsigned m_sub_bucket_magnitude;
+
+        // The number of counters of the other power of two ranges (half of the first one).
+        uint64_t m_sub_bucket_half_count;
+
+        // The number of counters.
+        size_t m_length;
+
+        // The counters.
+        std::unique_ptr<std::atomic<uint64_t>[]> m_counts;
+
+        // The number of recorded values.
+        std::atomic<uint64_t> m_total;
+
+        // The smallest and greatest recorded values.
+        std::atomic<uint64_t> m_min;
+        std::atomic<uint64_t> m_max;
+
+        // The sum of the recorded values.
+        std::atomic<uint64_t> m_sum;
+
+        // It returns the index of the counter of the given value.
+        size_t index(uint64_t value) const;
+
+        // It returns the greatest value counted by the counter at the given index.
+        uint64_t highest_value(size_t index) const;
+
+    public:
+
+        /*!
+         * \brief
+         * It creates an empty histogram.
+         *
+         * \param[in] name
+         * The name written in the summary.
+         *
+         * \param[in] highest
+         * The highest trackable value, in nanoseconds (one minute by default).
+         *
+         * \param[in] digits
+         * The number of significant decimal digits kept (from 1 to 5).
+         */
+        explicit Histogram(const std::string &name, uint64_t highest = 60000000000ULL, unsigned digits = 3);
+
+        ~Histogram();
+
+        Histogram(const Histogram &) = delete;
+        Histogram &operator=(const Histogram &) = delete;
+
+        /*!
+         * \brief
+         * It records a value (thread-safe, lock-free).
+         *
+         * \param[in] nanoseconds
+         * The value, in nanoseconds.
+         *
+         * \returns
+         * void.
+         */
+        void record(uint64_t nanoseconds);
+
+        /*!
+         * \brief
+         * It records a duration (thread-safe, lock-free).
+         *
+         * \param[in] duration
+         * The duration.
+         *
+         * \returns
+         * void.
+         */
+        template<typename REP, typename PERIOD>
+        void record(std::chrono::duration<REP, PERIOD> duration) {
+           auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+           this->record(static_cast<uint64_t>(nanoseconds > 0 ? nanoseconds : 0));
+        }
+
+        /*!
+         * \brief
+         * It computes the given percentile of the recorded values.
+         *
+         * \param[in] percentile
+         * The percentile, between 0 and 100.
+         *
+         * \returns
+         * The greatest value equivalent (within the precision of the histogram) to the percentile,
+         * in nanoseconds, 0 when no value has been recorded.
+         */
+        uint64_t percentile(double percentile) const;
+
+        /*!
+         * \brief
+         * It returns the number of recorded values.
+         *
+         * \returns
+         * See the brief description.
+         */
+        uint64_t count() const;
+
+        /*!
+         * \brief
+         * It returns the smallest recorded value, in nanoseconds (0 when no value has been recorded).
+         *
+         * \returns
+         * See the brief description.
+         */
+        uint64_t min() const;
+
+        /*!
+         * \brief
+         * It returns the greatest recorded value, in nanoseconds.
+         *
+         * \returns
+         * See the brief description.
+         */
+        uint64_t max() const;
+
+        /*!
+         * \brief
+         * It returns the mean of the recorded values, in nanoseconds.
+         *
+         * \returns
+         * See the brief description.
+         */
+        double mean() const;
+
+        /*!
+         * \brief
+         * It returns the name of the histogram.
+         *
+         * \returns
+         * See the brief description.
+         */
+        const std::string &name() const;
+
+        /*!
+         * \brief
+         * It describes the recorded values in a single line (count, minimum, mean, p50, p90, p99,
+         * p99.9 and maximum).
+         *
+         * \returns
+         * See the brief description.
+         */
+        std::string summary() const;
+    };
+}
+
+#endif
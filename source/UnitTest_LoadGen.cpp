@@ -0,0 +1,141 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "UnitTest_LoadGen.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Console.hpp"
+#include "UnitTest_TestManager.hpp"
+
+namespace {
+
+   // Requests intended to start sooner than this are waited for spinning instead of sleeping
+   const std::chrono::microseconds SPIN_THRESHOLD(100);
+}
+
+UnitTest::LoadGen::LoadGen(const std::string &name) :
+   m_rate(1000.0),
+   m_threads(1),
+   m_duration(1.0),
+   m_latency(name + " latency"),
+   m_service_time(name + " service time"),
+   m_lag(name + " start lag"),
+   m_sent(0),
+   m_errors(0),
+   m_elapsed(0.0) {
+}
+
+UnitTest::LoadGen &UnitTest::LoadGen::rate(double per_second) {
+   m_rate = std::max(per_second, 1e-3);
+   return *this;
+}
+
+UnitTest::LoadGen &UnitTest::LoadGen::threads(unsigned threads) {
+   m_threads = std::max(threads, 1u);
+   return *this;
+}
+
+UnitTest::LoadGen &UnitTest::LoadGen::duration(double seconds) {
+   m_duration = std::max(seconds, 0.0);
+   return *this;
+}
+
+UnitTest::LoadGen &UnitTest::LoadGen::run(const std::function<void(void)> &request) {
+
+   typedef std::chrono::steady_clock clock;
+
+   uint64_t requests = static_cast<uint64_t>(m_rate * m_duration);
+   std::chrono::duration<double> interval(1.0 / m_rate);
+   std::atomic<uint64_t> next(0);
+   clock::time_point start = clock::now() + std::chrono::milliseconds(1);
+
+   // Each thread takes the next request of the schedule: it waits for its intended start, or it
+   // starts it at once when the handler is behind schedule. Failures of the handler are credited
+   // to the UT_TEST_CASE generating the load, while the calling thread only runs the framework.
+   UnitTest::Allocations::Pause pause;
+   CaseContext *context = UnitTest::TestManager::m_context;
+   auto worker = [&]() -> void {
+      UnitTest::TestManager::set_current_case(context);
+      for (uint64_t k = next++; k < requests; k = next++) {
+         clock::time_point intended = start + std::chrono::duration_cast<clock::duration>(interval * double(k));
+         if (intended - clock::now() > SPIN_THRESHOLD) std::this_thread::sleep_until(intended - SPIN_THRESHOLD);
+         while (clock::now() < intended) std::this_thread::yield();
+
+         clock::time_point begin = clock::now();
+         try { request(); }
+         catch (...) { ++m_errors; }
+         clock::time_point end = clock::now();
+
+         m_latency.record(end - intended);
+         m_service_time.record(end - begin);
+         m_lag.record(begin - intended);
+         ++m_sent;
+      }
+      UnitTest::TestManager::set_current_case(nullptr);
+   };
+
+   std::vector<std::thread> pool;
+   for (unsigned idx = 0; idx < m_threads; ++idx) pool.push_back(std::thread(worker));
+   for (auto it = std::begin(pool); it != std::end(pool); ++it) it->join();
+   m_elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+   std::stringstream ss;
+   ss << std::fixed << std::setprecision(0) << "   load " << m_rate << " req/s from " << m_threads
+      << " threads for " << std::setprecision(2) << m_duration << " s: " << m_sent.load() << " requests, "
+      << m_errors.load() << " errors, achieved " << std::setprecision(0) << this->achieved_rate() << " req/s" << std::endl;
+   std::string content = ss.str();
+   ::Console::Write(content);
+
+   return *this;
+}
+
+const UnitTest::Histogram &UnitTest::LoadGen::latency() const {
+   return m_latency;
+}
+
+const UnitTest::Histogram &UnitTest::LoadGen::service_time() const {
+   return m_service_time;
+}
+
+const UnitTest::Histogram &UnitTest::LoadGen::lag() const {
+   return m_lag;
+}
+
+uint64_t UnitTest::LoadGen::sent() const {
+   return m_sent.load();
+}
+
+uint64_t UnitTest::LoadGen::errors() const {
+   return m_errors.load();
+}
+
+double UnitTest::LoadGen::achieved_rate() const {
+   return (m_elapsed > 0.0) ? m_sent.load() / m_elapsed : 0.0;
+}
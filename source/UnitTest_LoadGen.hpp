@@ -0,0 +1,196 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <functional>
+#include <cstdint>
+#include <string>
+#include <atomic>
+
+#include "UnitTest_Histogram.hpp"
+
+#ifndef _UNIT_TEST_LOADGEN_HPP_
+#define _UNIT_TEST_LOADGEN_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * An open-loop load generator: it calls a request handler at a fixed arrival rate from a pool
+     * of threads for a given time. Request k is intended to start k / rate seconds after the
+     * beginning whatever happened to the previous ones, and its latency is measured from that
+     * intended start, so that the time requests wait while the handler falls behind is not
+     * omitted (coordinated omission).
+     *
+     * \notes
+     * The latencies are recorded by three Histograms whose summaries are written in the footer
+     * of the UT_TEST_SUITE, and they can be checked with AssertPercentileBelow. Exceptions thrown
+     * by the handler are counted as errors.
+     **/
+    class LoadGen {
+
+    private:
+
+        // The number of requests started per second.
+        double m_rate;
+
+        // The number of threads calling the handler.
+        unsigned m_threads;
+
+        // The time, in seconds, requests are started for.
+        double m_duration;
+
+        // The time from the intended start to the end of each request.
+        Histogram m_latency;
+
+        // The time from the actual start to the end of each request.
+        Histogram m_service_time;
+
+        // The time from the intended start to the actual start of each request.
+        Histogram m_lag;
+
+        // The number of requests executed.
+        std::atomic<uint64_t> m_sent;
+
+        // The number of requests that threw an exception.
+        std::atomic<uint64_t> m_errors;
+
+        // The time, in seconds, spent executing the requests.
+        double m_elapsed;
+
+    public:
+
+        /*!
+         * \brief
+         * It creates a load generator starting 1000 requests per second from one thread for one second.
+         *
+         * \param[in] name
+         * The name of the load, it prefixes the names of the histograms.
+         */
+        explicit LoadGen(const std::string &name);
+
+        /*!
+         * \brief
+         * It sets the arrival rate.
+         *
+         * \param[in] per_second
+         * The number of requests started per second.
+         *
+         * \returns
+         * The load generator.
+         */
+        LoadGen &rate(double per_second);
+
+        /*!
+         * \brief
+         * It sets the number of threads calling the handler.
+         *
+         * \param[in] threads
+         * The number of threads.
+         *
+         * \returns
+         * The load generator.
+         */
+        LoadGen &threads(unsigned threads);
+
+        /*!
+         * \brief
+         * It sets the time requests are started for.
+         *
+         * \param[in] seconds
+         * The time, in seconds.
+         *
+         * \returns
+         * The load generator.
+         */
+        LoadGen &duration(double seconds);
+
+        /*!
+         * \brief
+         * It drives the given handler and it records the latencies of its requests.
+         *
+         * \param[in] request
+         * The request handler.
+         *
+         * \returns
+         * The load generator.
+         */
+        LoadGen &run(const std::function<void(void)> &request);
+
+        /*!
+         * \brief
+         * It returns the latencies measured from the intended start of the requests.
+         *
+         * \returns
+         * See the brief description.
+         */
+        const Histogram &latency() const;
+
+        /*!
+         * \brief
+         * It returns the latencies measured from the actual start of the requests.
+         *
+         * \returns
+         * See the brief description.
+         */
+        const Histogram &service_time() const;
+
+        /*!
+         * \brief
+         * It returns the delays between the intended and the actual start of the requests.
+         *
+         * \returns
+         * See the brief description.
+         */
+        const Histogram &lag() const;
+
+        /*!
+         * \brief
+         * It returns the number of requests executed.
+         *
+         * \returns
+         * See the brief description.
+         */
+        uint64_t sent() const;
+
+        /*!
+         * \brief
+         * It returns the number of requests that threw an exception.
+         *
+         * \returns
+         * See the brief description.
+         */
+        uint64_t errors() const;
+
+        /*!
+         * \brief
+         * It returns the number of requests completed per second.
+         *
+         * \returns
+         * See the brief description.
+         */
+        double achieved_rate() const;
+    };
+}
+
+#endif
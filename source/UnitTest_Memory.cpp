@@ -0,0 +1,168 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+#include "UnitTest_Memory.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_TestManager.hpp"
+#include "UnitTest_Console.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool UnitTest::Memory::m_enabled = false;
+
+namespace {
+
+   // The number of measurements in progress in the process
+   std::atomic<unsigned> g_active(0);
+
+   // The highest peak resident set read before a nested measurement restarted it, so that the
+   // enclosing measurements still see it
+   std::atomic<uint64_t> g_carried(0);
+
+   // It holds whether the user has been told that peak resident sets are not measured with --threads
+   std::atomic<bool> g_warned(false);
+
+   // It counts a measurement in progress while it lives, also when the measured code throws
+   struct Active {
+      bool nested;
+      Active() : nested(g_active.fetch_add(1) > 0) {}
+      ~Active() { g_active.fetch_sub(1); }
+   };
+
+#if defined(__linux__)
+   // It reads a field, given in kB, of /proc/self/status (without allocating memory)
+   uint64_t status_field(const char *field) {
+      char buffer[8192];
+      int fd = open("/proc/self/status", O_RDONLY);
+      if (fd < 0) return 0;
+      ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+      close(fd);
+      if (size <= 0) return 0;
+      buffer[size] = '\0';
+
+      const char *found = std::strstr(buffer, field);
+      if (found == nullptr) return 0;
+      return std::strtoull(found + std::strlen(field), nullptr, 10) * 1024;
+   }
+#endif
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+   // The peak resident set of the process according to getrusage
+   uint64_t max_rss() {
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+      return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+      return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+   }
+#endif
+}
+
+void UnitTest::Memory::set_enabled(bool enabled) {
+   Memory::m_enabled = enabled;
+}
+
+bool UnitTest::Memory::enabled() {
+   return Memory::m_enabled;
+}
+
+uint64_t UnitTest::Memory::resident() {
+#if defined(__linux__)
+   return status_field("VmRSS:");
+#else
+   return 0;
+#endif
+}
+
+uint64_t UnitTest::Memory::peak_resident() {
+#if defined(__linux__)
+   uint64_t peak = status_field("VmHWM:");
+   if (peak > 0) return peak;
+#endif
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+   return max_rss();
+#else
+   return 0;
+#endif
+}
+
+bool UnitTest::Memory::reset_peak_resident() {
+#if defined(__linux__)
+   // Writing 5 to clear_refs restarts VmHWM (Linux 4.0 and later)
+   int fd = open("/proc/self/clear_refs", O_WRONLY);
+   if (fd < 0) return false;
+   bool reset = (write(fd, "5", 1) == 1);
+   close(fd);
+   return reset;
+#else
+   return false;
+#endif
+}
+
+UnitTest::MemoryUsage UnitTest::Memory::measure(const std::function<void(void)> &code) {
+
+   // Restarting the peak resident set of the process would spoil the peaks of the UT_TEST_CASEs
+   // running at the same time, only the heap is measured then
+   Active active;
+   if (UnitTest::TestManager::m_threads > 1) {
+      if (!g_warned.exchange(true)) {
+         std::string warning = "Peak resident sets are not measured per test case with --threads, only heap peaks are\n";
+         ::Console::WriteError(warning);
+      }
+      MemoryUsage usage = { UnitTest::Allocations::measure(code).peak_bytes, 0, 0, false };
+      return usage;
+   }
+
+   // The peak reached so far by the enclosing measurement is kept before restarting it
+   uint64_t resident = Memory::resident();
+   if (active.nested) {
+      uint64_t peak = Memory::peak_resident();
+      for (uint64_t carried = g_carried.load(); carried < peak && !g_carried.compare_exchange_weak(carried, peak);) {}
+   }
+   else g_carried.store(0);
+   uint64_t before = Memory::reset_peak_resident() ? 0 : Memory::peak_resident();
+   resident = std::max(resident, before);
+
+   MemoryUsage usage;
+   usage.peak_heap = UnitTest::Allocations::measure(code).peak_bytes;
+   usage.peak_resident = std::max(std::max(Memory::peak_resident(), Memory::resident()), active.nested ? 0 : g_carried.load());
+   usage.peak_resident_growth = (usage.peak_resident > resident) ? usage.peak_resident - resident : 0;
+   usage.resident_measured = true;
+   return usage;
+}
+
+uint64_t UnitTest::Memory::peak(const MemoryUsage &usage) {
+   return UnitTest::Allocations::enabled() ? usage.peak_heap : usage.peak_resident_growth;
+}
@@ -0,0 +1,150 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <functional>
+#include <cstdint>
+
+#ifndef _UNIT_TEST_MEMORY_HPP_
+#define _UNIT_TEST_MEMORY_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * The memory used while executing some code.
+     **/
+    struct MemoryUsage {
+
+        // The growth of the live heap memory of the calling thread above its value at the start,
+        // in bytes (0 without UT_TRACK_ALLOCATIONS()).
+        uint64_t peak_heap;
+
+        // The growth of the resident set of the process above its size at the start, in bytes.
+        uint64_t peak_resident_growth;
+
+        // The peak resident set of the process, in bytes.
+        uint64_t peak_resident;
+
+        // False when the peak resident set could not be restarted for the code alone (it runs with
+        // other UT_TEST_CASEs under --threads): the two fields above are 0 then.
+        bool resident_measured;
+    };
+
+    /*!
+     * \brief
+     * It measures the peak memory used by code: the peak of the live heap memory of the calling
+     * thread, when allocations are tracked, and the peak resident set of the process. On Linux the
+     * peak resident set is restarted before measuring, elsewhere (or when it cannot be restarted)
+     * the growth is the one of the peak of the whole process, so it is at least the real one only
+     * once code has gone beyond all the previous peaks. The peak resident set belongs to the whole
+     * process: it is not measured with --threads, since restarting it would spoil the peaks of the
+     * UT_TEST_CASEs running at the same time; a measurement inside another one keeps the peak of
+     * the enclosing measurement before restarting it.
+     **/
+    class Memory {
+
+    private:
+
+        // It holds whether the memory of each UT_TEST_CASE is measured and reported.
+        static bool m_enabled;
+
+    public:
+
+        /*!
+         * \brief
+         * It sets whether the memory of each UT_TEST_CASE is measured and reported.
+         *
+         * \param[in] enabled
+         * True to measure and report it.
+         *
+         * \returns
+         * void.
+         */
+        static void set_enabled(bool enabled);
+
+        /*!
+         * \brief
+         * It tells whether the memory of each UT_TEST_CASE is measured and reported.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It returns the resident set of the process.
+         *
+         * \returns
+         * The resident set, in bytes (0 when unknown).
+         */
+        static uint64_t resident();
+
+        /*!
+         * \brief
+         * It returns the peak resident set of the process since its start or its last restart.
+         *
+         * \returns
+         * The peak resident set, in bytes (0 when unknown).
+         */
+        static uint64_t peak_resident();
+
+        /*!
+         * \brief
+         * It restarts the peak resident set of the process from its current resident set.
+         *
+         * \returns
+         * True when the peak has been restarted.
+         */
+        static bool reset_peak_resident();
+
+        /*!
+         * \brief
+         * It measures the memory used while executing code. Memory is read without allocating
+         * it, so that allocations measured around code are not disturbed.
+         *
+         * \param[in] code
+         * The code to be measured.
+         *
+         * \returns
+         * See MemoryUsage.
+         */
+        static MemoryUsage measure(const std::function<void(void)> &code);
+
+        /*!
+         * \brief
+         * It returns the peak memory of a measurement checked by AssertMaxPeakMemory: the peak of
+         * the heap when allocations are tracked (it is exact and not disturbed by other threads),
+         * the growth of the resident set otherwise (0 when it has not been measured).
+         *
+         * \param[in] usage
+         * The measurement.
+         *
+         * \returns
+         * The peak memory, in bytes.
+         */
+        static uint64_t peak(const MemoryUsage &usage);
+    };
+}
+
+#endif // _UNIT_TEST_MEMORY_HPP_
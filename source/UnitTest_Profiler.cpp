@@ -0,0 +1,344 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <map>
+
+#include "UnitTest_Profiler.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_TestManager.hpp"
+#include "UnitTest_Console.hpp"
+#include "UnitTest_Utility.hpp"
+
+// Stacks are walked through frame pointers, read from the registers saved by the signal
+#if (defined(__linux__) || defined(__APPLE__)) && (defined(__x86_64__) || defined(__aarch64__))
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#define UT_HAS_PROFILER 1
+#endif
+
+#if defined(__linux__) && defined(UT_HAS_PROFILER)
+#include <sys/syscall.h>
+#include <time.h>
+#if !defined(sigev_notify_thread_id)
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+std::string UnitTest::Profiler::m_directory;
+double UnitTest::Profiler::m_threshold = 0.0;
+
+namespace {
+
+#if defined(UT_HAS_PROFILER)
+   // The sampling frequency, not a round number so that it does not beat with periodic work
+   const long SAMPLING_FREQUENCY = 997;
+
+   // The largest number of frames of a sample
+   const int MAX_DEPTH = 64;
+
+   // The size of the buffer of the samples of each thread, in words (a word for the depth of each sample, then its frames)
+   const size_t BUFFER_WORDS = 1 << 20;
+
+   // The samples of a thread. It is trivial, so that the signal handler can use it without
+   // initializing thread-local storage.
+   struct Buffer {
+      void **data;
+      size_t used;
+      size_t samples;
+      size_t dropped;
+      double duration;
+
+      // The frame of Profiler::profile: the frames of the body are below it
+      uintptr_t top;
+   };
+
+   thread_local Buffer t_buffer;
+
+   // It holds whether the samples of the thread are taken
+   thread_local volatile sig_atomic_t t_active;
+
+   // It unmaps the buffer of a thread when the thread ends
+   struct Unmapper {
+      void **data = nullptr;
+      ~Unmapper() {
+         t_active = 0;
+         t_buffer.data = nullptr;
+         if (data != nullptr) munmap(data, BUFFER_WORDS * sizeof(void *));
+      }
+   };
+
+   thread_local Unmapper t_unmapper;
+
+   // It reads the instruction and frame pointers of the interrupted code
+   void registers(void *context, uintptr_t &pc, uintptr_t &fp) {
+      ucontext_t *registers = static_cast<ucontext_t *>(context);
+#if defined(__linux__) && defined(__x86_64__)
+      pc = static_cast<uintptr_t>(registers->uc_mcontext.gregs[REG_RIP]);
+      fp = static_cast<uintptr_t>(registers->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__linux__)
+      pc = static_cast<uintptr_t>(registers->uc_mcontext.pc);
+      fp = static_cast<uintptr_t>(registers->uc_mcontext.regs[29]);
+#elif defined(__x86_64__)
+      pc = static_cast<uintptr_t>(registers->uc_mcontext->__ss.__rip);
+      fp = static_cast<uintptr_t>(registers->uc_mcontext->__ss.__rbp);
+#else
+      pc = static_cast<uintptr_t>(registers->uc_mcontext->__ss.__pc);
+      fp = static_cast<uintptr_t>(registers->uc_mcontext->__ss.__fp);
+#endif
+   }
+
+   // It stores the call stack of the interrupted thread. The stack is walked through the frame
+   // pointers (each frame starts with the frame pointer of its caller, followed by the return
+   // address), reading only the stack between the frame of the handler and the one of
+   // Profiler::profile: no unwinder is involved, so that it is async-signal-safe also while the
+   // thread unwinds an exception. A walk that does not reach Profiler::profile (code built
+   // without frame pointers) ends with a null frame.
+   void on_sample(int, siginfo_t *, void *context) {
+      int saved = errno;
+      Buffer &buffer = t_buffer;
+      if (t_active && buffer.data != nullptr) {
+         if (buffer.used + MAX_DEPTH + 1 > BUFFER_WORDS) {
+            ++buffer.dropped;
+         } else {
+            void **frames = buffer.data + buffer.used + 1;
+            uintptr_t pc = 0, fp = 0;
+            registers(context, pc, fp);
+            uintptr_t bottom = reinterpret_cast<uintptr_t>(&saved);
+            int depth = 0;
+            frames[depth++] = reinterpret_cast<void *>(pc);
+            bool complete = false;
+            while (depth < MAX_DEPTH - 1 && fp > bottom && fp < buffer.top && fp % sizeof(void *) == 0) {
+               uintptr_t caller = reinterpret_cast<uintptr_t *>(fp)[0];
+               if (caller >= buffer.top) {
+                  complete = true;
+                  break;
+               }
+               if (caller <= fp) break;
+               frames[depth++] = reinterpret_cast<void **>(fp)[1];
+               fp = caller;
+            }
+            if (!complete) frames[depth++] = nullptr;
+            buffer.data[buffer.used] = reinterpret_cast<void *>(static_cast<intptr_t>(depth));
+            buffer.used += depth + 1;
+            ++buffer.samples;
+         }
+      }
+      errno = saved;
+   }
+
+   void install() {
+      struct sigaction action;
+      std::memset(&action, 0, sizeof(action));
+      action.sa_sigaction = on_sample;
+      action.sa_flags = SA_RESTART | SA_SIGINFO;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGPROF, &action, nullptr);
+   }
+
+   // It sends SIGPROF to the calling thread while it is alive, every 1 / SAMPLING_FREQUENCY
+   // seconds of its CPU time. On Linux the timer is a POSIX timer created through system calls
+   // (timer_create needs librt with older C libraries).
+   class Sampling {
+
+   private:
+
+      // The kernel identifier of the timer (-1 when it has not been created).
+      int m_timer;
+
+   public:
+
+      Sampling() : m_timer(-1) {
+         long period = 1000000000L / SAMPLING_FREQUENCY;
+#if defined(__linux__)
+         struct sigevent event;
+         std::memset(&event, 0, sizeof(event));
+         event.sigev_notify = SIGEV_THREAD_ID;
+         event.sigev_signo = SIGPROF;
+         event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+         int timer = -1;
+         if (syscall(SYS_timer_create, CLOCK_THREAD_CPUTIME_ID, &event, &timer) == 0) {
+            m_timer = timer;
+            struct itimerspec spec;
+            spec.it_interval.tv_sec = spec.it_value.tv_sec = 0;
+            spec.it_interval.tv_nsec = spec.it_value.tv_nsec = period;
+            syscall(SYS_timer_settime, m_timer, 0, &spec, nullptr);
+         }
+#else
+         struct itimerval spec;
+         spec.it_interval.tv_sec = spec.it_value.tv_sec = 0;
+         spec.it_interval.tv_usec = spec.it_value.tv_usec = period / 1000;
+         setitimer(ITIMER_PROF, &spec, nullptr);
+#endif
+         t_active = 1;
+      }
+
+      ~Sampling() {
+         t_active = 0;
+#if defined(__linux__)
+         if (m_timer >= 0) syscall(SYS_timer_delete, m_timer);
+#else
+         struct itimerval spec;
+         std::memset(&spec, 0, sizeof(spec));
+         setitimer(ITIMER_PROF, &spec, nullptr);
+#endif
+      }
+
+      Sampling(const Sampling &) = delete;
+      Sampling &operator=(const Sampling &) = delete;
+   };
+
+   // It replaces the characters that do not belong in a file name
+   std::string file_name(const std::string &name) {
+      std::string file = name;
+      for (auto it = std::begin(file); it != std::end(file); ++it) {
+         if (!std::isalnum(static_cast<unsigned char>(*it)) && *it != '.' && *it != '_' && *it != '-') *it = '_';
+      }
+      return file;
+   }
+#endif
+}
+
+void UnitTest::Profiler::set_directory(const std::string &directory) {
+   Profiler::m_directory = directory;
+#if defined(UT_HAS_PROFILER)
+   if (!directory.empty() && mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      std::string error = "The profiles directory " + directory + " cannot be created\n";
+      ::Console::WriteError(error);
+   }
+#endif
+}
+
+void UnitTest::Profiler::set_threshold(double seconds) {
+   Profiler::m_threshold = (seconds > 0.0) ? seconds : 0.0;
+}
+
+bool UnitTest::Profiler::enabled() {
+#if defined(UT_HAS_PROFILER) && !defined(__linux__)
+   // The timer measures the CPU time of the whole process: with --threads the samples of each
+   // UT_TEST_CASE would land in the others
+   if (!Profiler::m_directory.empty() && UnitTest::TestManager::m_threads > 1) {
+      static std::atomic<bool> warned(false);
+      if (!warned.exchange(true)) {
+         std::string warning = "Test cases are not profiled with --threads on this system\n";
+         ::Console::WriteError(warning);
+      }
+      return false;
+   }
+#endif
+   return !Profiler::m_directory.empty();
+}
+
+void UnitTest::Profiler::profile(const std::function<void(void)> &code) {
+#if defined(UT_HAS_PROFILER)
+   static std::once_flag installed;
+   std::call_once(installed, install);
+
+   // The buffer is mapped, not allocated, so that it is not accounted to the UT_TEST_CASE (it
+   // lives as long as the thread)
+   Buffer &buffer = t_buffer;
+   if (buffer.data == nullptr) {
+      UnitTest::Allocations::Pause pause;
+      void *data = mmap(nullptr, BUFFER_WORDS * sizeof(void *), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (data == MAP_FAILED) {
+         code();
+         return;
+      }
+      buffer.data = t_unmapper.data = static_cast<void **>(data);
+   }
+
+   buffer.used = buffer.samples = buffer.dropped = 0;
+   buffer.top = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+   auto start = std::chrono::steady_clock::now();
+   try {
+      Sampling sampling;
+      code();
+   }
+   catch (...) {
+      buffer.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      throw;
+   }
+   buffer.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#else
+   code();
+#endif
+}
+
+void UnitTest::Profiler::save(const char *suite, const char *name) {
+#if defined(UT_HAS_PROFILER)
+   Buffer &buffer = t_buffer;
+   if (buffer.data == nullptr || buffer.samples == 0 || buffer.duration < Profiler::m_threshold) {
+      buffer.used = buffer.samples = buffer.dropped = 0;
+      return;
+   }
+
+   // Frames are named once and the name of the case becomes the root of its stacks
+   std::string root = std::string(suite) + "." + name;
+   std::unordered_map<void *, std::string> names;
+   std::map<std::string, size_t> stacks;
+   for (size_t position = 0; position < buffer.used; ) {
+      int depth = static_cast<int>(reinterpret_cast<intptr_t>(buffer.data[position]));
+      void **frames = buffer.data + position + 1;
+      position += depth + 1;
+
+      std::vector<const std::string *> symbols;
+      for (int idx = 0; idx < depth; ++idx) {
+         // Return addresses are moved back into the calling instruction, except the interrupted one
+         void *address = (idx == 0 || frames[idx] == nullptr) ? frames[idx] : static_cast<char *>(frames[idx]) - 1;
+         auto it = names.find(address);
+         if (it == names.end()) it = names.insert(std::make_pair(address, address == nullptr ? std::string("[unknown]") :
+                                                                 UnitTest::Utility::symbolize(address, false))).first;
+         symbols.push_back(&it->second);
+      }
+
+      std::string stack = root;
+      for (auto it = symbols.rbegin(); it != symbols.rend(); ++it) stack += ";" + **it;
+      ++stacks[stack];
+   }
+
+   std::string path = Profiler::m_directory + "/" + file_name(root) + ".folded";
+   std::ofstream out(path.c_str(), std::ios::out | std::ios::trunc);
+   for (auto it = std::begin(stacks); it != std::end(stacks); ++it) out << it->first << " " << it->second << std::endl;
+
+   std::stringstream ss;
+   ss << name << ": " << buffer.samples << " samples";
+   if (buffer.dropped > 0) ss << " (" << buffer.dropped << " dropped, the buffer is full)";
+   ss << (out ? " written to " : " not written to ") << path;
+   UnitTest::TestManager::add_note(ss.str());
+   buffer.used = buffer.samples = buffer.dropped = 0;
+#endif
+}
@@ -0,0 +1,126 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <functional>
+#include <string>
+
+#ifndef _UNIT_TEST_PROFILER_HPP_
+#define _UNIT_TEST_PROFILER_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It samples the call stacks of the thread executing a UT_TEST_CASE: a timer measuring the CPU
+     * time of the thread sends it SIGPROF about a thousand times per second and the signal handler
+     * walks the call stack through the frame pointers, storing it in a buffer mapped in advance,
+     * without allocating memory nor taking locks. Once the body is over the stacks are folded (one line per distinct stack, frames from
+     * the root separated by semicolons, followed by the number of samples) into a file per case,
+     * that flame graph tools (e.g. flamegraph.pl, speedscope) read.
+     *
+     * \notes
+     * Threads started by the body are not sampled. Stacks are complete only through code built
+     * with frame pointers (-fno-omit-frame-pointer), the others hang from an [unknown] frame.
+     * Functions of the tester are named only when it is linked with -rdynamic. It is available on
+     * x86-64 and AArch64, on Linux and macOS; elsewhere than on Linux the timer measures the CPU
+     * time of the process, so UT_TEST_CASEs are not profiled with --threads.
+     **/
+    class Profiler {
+
+    private:
+
+        // The directory of the folded stacks (empty when profiling is disabled).
+        static std::string m_directory;
+
+        // The wall time, in seconds, a body must last for its samples to be written.
+        static double m_threshold;
+
+    public:
+
+        /*!
+         * \brief
+         * It enables the profiling of each UT_TEST_CASE, writing the folded stacks in a directory
+         * (created when missing).
+         *
+         * \param[in] directory
+         * The directory of the folded stacks, empty to disable profiling.
+         *
+         * \returns
+         * void.
+         */
+        static void set_directory(const std::string &directory);
+
+        /*!
+         * \brief
+         * It sets the wall time a body must last for its samples to be written, so that a run
+         * profiles only its slow cases.
+         *
+         * \param[in] seconds
+         * The threshold, in seconds (0 to write the samples of each case).
+         *
+         * \returns
+         * void.
+         */
+        static void set_threshold(double seconds);
+
+        /*!
+         * \brief
+         * It tells whether UT_TEST_CASEs are profiled.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It samples the call stacks of the calling thread while executing code. The samples are
+         * kept until the next call of save on the same thread.
+         *
+         * \param[in] code
+         * The code to be profiled.
+         *
+         * \returns
+         * void.
+         */
+        static void profile(const std::function<void(void)> &code);
+
+        /*!
+         * \brief
+         * It writes the samples taken by the last profile of the calling thread as folded stacks,
+         * when its code lasted at least the threshold, and it discards them.
+         *
+         * \param[in] suite
+         * The name of the UT_TEST_SUITE.
+         *
+         * \param[in] name
+         * The name of the UT_TEST_CASE.
+         *
+         * \returns
+         * void.
+         */
+        static void save(const char *suite, const char *name);
+    };
+}
+
+#endif // _UNIT_TEST_PROFILER_HPP_
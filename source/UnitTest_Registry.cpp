@@ -0,0 +1,178 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "UnitTest_Registry.hpp"
+#include "UnitTest_Typed.hpp"
+
+// Static member initialization
+UnitTest::SuiteEntry *UnitTest::Registry::m_suites = nullptr;
+bool UnitTest::Registry::m_finalized = false;
+std::unordered_map<std::string, size_t> UnitTest::Registry::m_tag_ids;
+std::vector<uint64_t> UnitTest::Registry::m_tag_bits;
+size_t UnitTest::Registry::m_tag_words = 0;
+
+void UnitTest::Registry::link(SuiteEntry &suite) {
+   if (suite.linked) return;
+   suite.next = Registry::m_suites;
+   Registry::m_suites = &suite;
+   suite.linked = true;
+}
+
+void UnitTest::Registry::link(CaseEntry &entry) {
+
+   Registry::link(*entry.suite);
+
+   // Static initialization order is unspecified, the line keeps cases in definition order
+   CaseEntry **it = &entry.suite->cases;
+   while (*it != nullptr && (*it)->line <= entry.line) it = &(*it)->next;
+   entry.next = *it;
+   *it = &entry;
+}
+
+void UnitTest::Registry::enable(SuiteEntry &suite, const char *names) {
+   Registry::link(suite);
+   suite.enabled = names;
+}
+
+void UnitTest::Registry::finalize() {
+
+   if (Registry::m_finalized) return;
+   Registry::m_finalized = true;
+
+   // The instances of typed UT_TEST_CASEs are named here, since naming them allocates memory
+   UnitTest::TypedLinker::name_instances();
+
+   const char *token = nullptr;
+   size_t length = 0;
+   size_t cases = 0;
+
+   for (SuiteEntry *suite = Registry::m_suites; suite != nullptr; suite = suite->next) {
+      for (CaseEntry *entry = suite->cases; entry != nullptr; entry = entry->next) entry->order = -1;
+      if (suite->enabled == nullptr) continue;
+
+      long order = 0;
+      for (const char *it = Registry::next_token(suite->enabled, token, length); it != nullptr;
+           it = Registry::next_token(it, token, length), ++order) {
+         for (CaseEntry *entry = suite->cases; entry != nullptr; entry = entry->next) {
+            if (entry->order >= 0 || std::strncmp(entry->name, token, length) != 0) continue;
+            if (entry->name[length] == 0) {
+               entry->order = order;
+               break;
+            }
+
+            // The instances of a typed UT_TEST_CASE (named CASE<TYPE,SIZE>) are enabled by its name
+            if (entry->name[length] == '<') entry->order = order;
+         }
+      }
+   }
+
+   // Tags are interned, so that filtering a case is a test on the bits of its tags
+   for (SuiteEntry *suite = Registry::m_suites; suite != nullptr; suite = suite->next) {
+      for (CaseEntry *entry = suite->cases; entry != nullptr; entry = entry->next) {
+         entry->id = cases++;
+         for (const char *it = Registry::next_token(entry->tags, token, length); it != nullptr;
+              it = Registry::next_token(it, token, length)) {
+            Registry::m_tag_ids.insert(std::make_pair(std::string(token, length), Registry::m_tag_ids.size()));
+         }
+      }
+   }
+
+   Registry::m_tag_words = (Registry::m_tag_ids.size() + 63) / 64;
+   Registry::m_tag_bits.assign(cases * Registry::m_tag_words, 0);
+   for (SuiteEntry *suite = Registry::m_suites; suite != nullptr; suite = suite->next) {
+      for (CaseEntry *entry = suite->cases; entry != nullptr; entry = entry->next) {
+         uint64_t *bits = &Registry::m_tag_bits[0] + entry->id * Registry::m_tag_words;
+         for (const char *it = Registry::next_token(entry->tags, token, length); it != nullptr;
+              it = Registry::next_token(it, token, length)) {
+            size_t id = Registry::m_tag_ids[std::string(token, length)];
+            bits[id / 64] |= (uint64_t(1) << (id % 64));
+         }
+      }
+   }
+}
+
+long UnitTest::Registry::tag_id(const std::string &tag) {
+   auto it = Registry::m_tag_ids.find(tag);
+   return (it != Registry::m_tag_ids.end()) ? static_cast<long>(it->second) : -1;
+}
+
+const uint64_t *UnitTest::Registry::tag_bits(const CaseEntry &entry) {
+   return (Registry::m_tag_words > 0) ? &Registry::m_tag_bits[0] + entry.id * Registry::m_tag_words : nullptr;
+}
+
+UnitTest::SuiteEntry *UnitTest::Registry::suites() {
+   return Registry::m_suites;
+}
+
+UnitTest::SuiteEntry *UnitTest::Registry::find(const char *name) {
+   for (SuiteEntry *suite = Registry::m_suites; suite != nullptr; suite = suite->next) {
+      if (std::strcmp(suite->name, name) == 0) return suite;
+   }
+   return nullptr;
+}
+
+void UnitTest::Registry::enabled_cases(const SuiteEntry &suite, std::vector<CaseEntry *> &cases) {
+   cases.clear();
+   for (CaseEntry *entry = suite.cases; entry != nullptr; entry = entry->next) {
+      if (entry->order >= 0) cases.push_back(entry);
+   }
+   std::stable_sort(cases.begin(), cases.end(), [](const CaseEntry *lhs, const CaseEntry *rhs) -> bool {
+      return lhs->order < rhs->order;
+   });
+}
+
+const char *UnitTest::Registry::next_token(const char *csv, const char *&token, size_t &length) {
+
+   while (csv != nullptr && *csv != 0) {
+      while (*csv == ' ' || *csv == '\t' || *csv == '\n' || *csv == '\r') ++csv;
+      const char *end = csv;
+      while (*end != 0 && *end != ',') ++end;
+
+      const char *last = end;
+      while (last > csv && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\n' || last[-1] == '\r')) --last;
+
+      const char *next = (*end == ',') ? end + 1 : end;
+      if (last > csv) {
+         token = csv;
+         length = static_cast<size_t>(last - csv);
+         return next;
+      }
+      csv = next; // empty tokens are skipped
+   }
+
+   return nullptr;
+}
+
+bool UnitTest::Registry::has_tag(const CaseEntry &entry, const char *tag, size_t length) {
+   const char *token = nullptr;
+   size_t token_length = 0;
+   for (const char *it = Registry::next_token(entry.tags, token, token_length); it != nullptr;
+        it = Registry::next_token(it, token, token_length)) {
+      if (token_length == length && std::strncmp(token, tag, length) == 0) return true;
+   }
+   return false;
+}
@@ -0,0 +1,380 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef _UNIT_TEST_REGISTRY_HPP_
+#define _UNIT_TEST_REGISTRY_HPP_
+
+namespace UnitTest {
+
+    struct SuiteEntry;
+
+    /*!
+     * \brief
+     * It describes a UT_TEST_CASE. Entries are constant initialized from the arguments of the
+     * UT_TEST_CASE macro and linked to their UT_TEST_SUITE during static initialization, so
+     * every UT_TEST_CASE is known before any UT_TEST_SUITE is executed.
+     **/
+    struct CaseEntry {
+
+        // The name of the UT_TEST_CASE.
+        const char *name;
+
+        // The CSV string of tags of the UT_TEST_CASE.
+        const char *tags;
+
+        // The line in which the UT_TEST_CASE has been defined.
+        long line;
+
+        // It tells whether the UT_TEST_CASE must be executed while no other one is (e.g. a UT_BENCHMARK).
+        bool exclusive;
+
+        // The UT_TEST_SUITE of the UT_TEST_CASE.
+        SuiteEntry *suite;
+
+        // The next UT_TEST_CASE of the same UT_TEST_SUITE, in definition order.
+        CaseEntry *next;
+
+        // The position of the UT_TEST_CASE in UT_ENABLE_TEST_CASES (-1 when it is not enabled).
+        long order;
+
+        // It tells whether the UT_TEST_CASE has been selected for execution by the runner.
+        bool selected;
+
+        // The index of the UT_TEST_CASE among all known ones (assigned by Registry::finalize).
+        size_t id;
+    };
+
+    /*!
+     * \brief
+     * It describes a UT_TEST_SUITE. Entries are constant initialized from the arguments of the
+     * UT_TEST_SUITE macro and linked in the list of known UT_TEST_SUITEs during static initialization.
+     **/
+    struct SuiteEntry {
+
+        // The name of the UT_TEST_SUITE.
+        const char *name;
+
+        // The file in which the UT_TEST_SUITE has been defined.
+        const char *file;
+
+        // The first UT_TEST_CASE of the UT_TEST_SUITE.
+        CaseEntry *cases;
+
+        // The CSV string of the names given to UT_ENABLE_TEST_CASES.
+        const char *enabled;
+
+        // The next known UT_TEST_SUITE.
+        SuiteEntry *next;
+
+        // It tells whether the UT_TEST_SUITE has been linked in the list of known UT_TEST_SUITEs.
+        bool linked;
+
+        // The number of UT_TEST_CASEs selected for execution by the runner.
+        size_t selected;
+    };
+
+    /*!
+     * \brief
+     * It holds the static tables of known UT_TEST_SUITEs and UT_TEST_CASEs.
+     **/
+    class Registry {
+
+    private:
+
+        // The first known UT_TEST_SUITE.
+        static SuiteEntry *m_suites;
+
+        // It holds whether the static tables have been finalized.
+        static bool m_finalized;
+
+        // It maps each known tag to its identifier.
+        static std::unordered_map<std::string, size_t> m_tag_ids;
+
+        // It holds, for each UT_TEST_CASE, the bitset of the identifiers of its tags.
+        static std::vector<uint64_t> m_tag_bits;
+
+        // The number of 64 bits words of each bitset in m_tag_bits.
+        static size_t m_tag_words;
+
+        // It links the given suite in the list of known UT_TEST_SUITEs.
+        static void link(SuiteEntry &suite);
+
+    public:
+
+        /*!
+         * \brief
+         * It links a UT_TEST_CASE to its UT_TEST_SUITE keeping the definition order.
+         *
+         * \param[in] entry
+         * The UT_TEST_CASE to be linked.
+         *
+         * \returns
+         * void.
+         */
+        static void link(CaseEntry &entry);
+
+        /*!
+         * \brief
+         * It records the CSV string of names given to UT_ENABLE_TEST_CASES by a UT_TEST_SUITE.
+         *
+         * \param[in] suite
+         * The UT_TEST_SUITE.
+         *
+         * \param[in] names
+         * The CSV string of names of the enabled UT_TEST_CASEs.
+         *
+         * \returns
+         * void.
+         */
+        static void enable(SuiteEntry &suite, const char *names);
+
+        /*!
+         * \brief
+         * It names the instances of typed UT_TEST_CASEs (see TypedLinker), it assigns to each
+         * UT_TEST_CASE its position in UT_ENABLE_TEST_CASES and its identifier, it interns all
+         * tags and builds the bitset of the tags of each UT_TEST_CASE. It must be called once
+         * static initialization is over, before the tables are used (further calls have no effect).
+         *
+         * \returns
+         * void.
+         */
+        static void finalize();
+
+        /*!
+         * \brief
+         * It returns the identifier of the given tag.
+         *
+         * \param[in] tag
+         * The tag.
+         *
+         * \returns
+         * The identifier of the tag, -1 when no UT_TEST_CASE has been tagged with it.
+         */
+        static long tag_id(const std::string &tag);
+
+        /*!
+         * \brief
+         * It returns the bitset of the identifiers of the tags of the given UT_TEST_CASE: the tag
+         * whose identifier is N is set when bit N % 64 of the word N / 64 is set.
+         *
+         * \param[in] entry
+         * The UT_TEST_CASE.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static const uint64_t *tag_bits(const CaseEntry &entry);
+
+        /*!
+         * \brief
+         * It returns the first known UT_TEST_SUITE, the others can be reached through the next
+         * member of each entry.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static SuiteEntry *suites();
+
+        /*!
+         * \brief
+         * It returns the UT_TEST_SUITE with the given name.
+         *
+         * \param[in] name
+         * The name of the UT_TEST_SUITE.
+         *
+         * \returns
+         * The UT_TEST_SUITE, nullptr when it is unknown.
+         */
+        static SuiteEntry *find(const char *name);
+
+        /*!
+         * \brief
+         * It fills the given vector with the enabled UT_TEST_CASEs of the given UT_TEST_SUITE, in
+         * the order they have been enabled.
+         *
+         * \param[in] suite
+         * The UT_TEST_SUITE.
+         *
+         * \param[out] cases
+         * The vector to be filled.
+         *
+         * \returns
+         * void.
+         */
+        static void enabled_cases(const SuiteEntry &suite, std::vector<CaseEntry *> &cases);
+
+        /*!
+         * \brief
+         * It finds the next token of a CSV string without allocating memory.
+         *
+         * \param[in] csv
+         * The position in the CSV string from which the token must be searched.
+         *
+         * \param[out] token
+         * The first character of the token.
+         *
+         * \param[out] length
+         * The length of the token (spaces around it are excluded).
+         *
+         * \returns
+         * The position from which the next token must be searched, nullptr when no token is left.
+         */
+        static const char *next_token(const char *csv, const char *&token, size_t &length);
+
+        /*!
+         * \brief
+         * It returns whether or not the given UT_TEST_CASE has been tagged with the given tag.
+         *
+         * \param[in] entry
+         * The UT_TEST_CASE.
+         *
+         * \param[in] tag
+         * The tag.
+         *
+         * \param[in] length
+         * The length of the tag.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool has_tag(const CaseEntry &entry, const char *tag, size_t length);
+    };
+
+    /*!
+     * \brief
+     * It links a UT_TEST_CASE entry during static initialization.
+     **/
+    struct CaseLinker {
+        explicit CaseLinker(CaseEntry &entry) { Registry::link(entry); }
+    };
+
+    /*!
+     * \brief
+     * It records the enabled UT_TEST_CASEs of a UT_TEST_SUITE during static initialization.
+     **/
+    struct EnableLinker {
+        EnableLinker(SuiteEntry &suite, const char *names) { Registry::enable(suite, names); }
+    };
+
+    /*!
+     * \brief
+     * It holds the entry of the UT_TEST_SUITE described by SUITE.
+     **/
+    template<typename SUITE>
+    struct SuiteRegistrar {
+        static SuiteEntry entry;
+    };
+
+    template<typename SUITE>
+    SuiteEntry SuiteRegistrar<SUITE>::entry = { SUITE::name(), SUITE::file(), nullptr, nullptr, nullptr, false, 0 };
+
+    /*!
+     * \brief
+     * It holds the entry of the UT_TEST_CASE described by CASE in the UT_TEST_SUITE described by
+     * SUITE. Using get() instantiates the linker, which links the entry at static initialization.
+     **/
+    template<typename SUITE, typename CASE>
+    struct CaseRegistrar {
+        static CaseEntry entry;
+        static CaseLinker linker;
+
+        static const CaseEntry &get() {
+           (void) &linker;
+           return entry;
+        }
+    };
+
+    template<typename SUITE, typename CASE>
+    CaseEntry CaseRegistrar<SUITE, CASE>::entry = {
+       CASE::name(), CASE::tags(), CASE::line(), CASE::exclusive(), &SuiteRegistrar<SUITE>::entry, nullptr, -1, false, 0
+    };
+
+    template<typename SUITE, typename CASE>
+    CaseLinker CaseRegistrar<SUITE, CASE>::linker(CaseRegistrar<SUITE, CASE>::entry);
+
+    /*!
+     * \brief
+     * It records, at static initialization, the UT_TEST_CASEs enabled by the UT_TEST_SUITE
+     * described by SUITE, whose names are given by NAMES.
+     **/
+    template<typename SUITE, typename NAMES>
+    struct EnableRegistrar {
+        static EnableLinker linker;
+
+        static SuiteEntry &get() {
+           (void) &linker;
+           return SuiteRegistrar<SUITE>::entry;
+        }
+    };
+
+    template<typename SUITE, typename NAMES>
+    EnableLinker EnableRegistrar<SUITE, NAMES>::linker(SuiteRegistrar<SUITE>::entry, NAMES::names());
+
+    /*!
+     * \brief
+     * It binds the body of a UT_TEST_CASE to its entry.
+     **/
+    class TestCase {
+
+    private:
+
+        // The entry of the UT_TEST_CASE.
+        const CaseEntry *m_entry;
+
+        // The body of the UT_TEST_CASE.
+        std::function<void(void)> m_body;
+
+        // The instances of a typed UT_TEST_CASE (nullptr for any other UT_TEST_CASE).
+        std::shared_ptr<std::vector<TestCase>> m_instances;
+
+    public:
+
+        explicit TestCase(const CaseEntry &entry) : m_entry(&entry) {}
+
+        explicit TestCase(const std::vector<TestCase> &instances) :
+           m_entry(nullptr), m_instances(std::make_shared<std::vector<TestCase>>(instances)) {}
+
+        TestCase &operator=(std::function<void(void)> body) {
+           m_body = body;
+           return *this;
+        }
+
+        const CaseEntry &entry() const { return *m_entry; }
+
+        std::function<void(void)> &body() { return m_body; }
+
+        const std::vector<TestCase> *instances() const { return m_instances.get(); }
+    };
+
+}
+
+#endif // _UNIT_TEST_REGISTRY_HPP_
@@ -25,4 +25,4 @@ DEALINGS IN THE SOFTWARE.
 #include "UnitTest_Requires.hpp"
 
 // Static member initialization
-std::stringstream UnitTest::Requires::ss;
+thread_local std::stringstream UnitTest::Requires::ss;
@@ -0,0 +1,131 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+#include "UnitTest_Resources.hpp"
+#include "UnitTest_Utility.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define UT_HAS_RUSAGE 1
+#endif
+
+bool UnitTest::Resources::m_enabled = false;
+
+namespace {
+
+   // A reading of the counters of the operating system
+   struct Reading {
+      uint64_t minor_faults;
+      uint64_t major_faults;
+      uint64_t voluntary_switches;
+      uint64_t involuntary_switches;
+      uint64_t read_bytes;
+      uint64_t write_bytes;
+   };
+
+#if defined(__linux__)
+   // It reads the block I/O of the calling thread (of the process before Linux 3.17) without allocating memory
+   void read_io(Reading &reading) {
+      reading.read_bytes = reading.write_bytes = 0;
+      int fd = open("/proc/thread-self/io", O_RDONLY);
+      if (fd < 0) fd = open("/proc/self/io", O_RDONLY);
+      if (fd < 0) return;
+      char buffer[1024];
+      ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+      close(fd);
+      if (size <= 0) return;
+      buffer[size] = '\0';
+
+      // read_bytes follows rchar and syscr, write_bytes follows wchar and syscw
+      const char *found = std::strstr(buffer, "\nread_bytes:");
+      if (found != nullptr) reading.read_bytes = std::strtoull(found + 12, nullptr, 10);
+      found = std::strstr(buffer, "\nwrite_bytes:");
+      if (found != nullptr) reading.write_bytes = std::strtoull(found + 13, nullptr, 10);
+   }
+#endif
+
+   bool take_reading(Reading &reading) {
+#if defined(UT_HAS_RUSAGE)
+      struct rusage usage;
+#if defined(__linux__)
+      if (getrusage(RUSAGE_THREAD, &usage) != 0) return false;
+      read_io(reading);
+#else
+      if (getrusage(RUSAGE_SELF, &usage) != 0) return false;
+      reading.read_bytes = reading.write_bytes = 0;
+#endif
+      reading.minor_faults = static_cast<uint64_t>(usage.ru_minflt);
+      reading.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+      reading.voluntary_switches = static_cast<uint64_t>(usage.ru_nvcsw);
+      reading.involuntary_switches = static_cast<uint64_t>(usage.ru_nivcsw);
+      return true;
+#else
+      return false;
+#endif
+   }
+
+   uint64_t difference(uint64_t after, uint64_t before) {
+      return (after > before) ? after - before : 0;
+   }
+}
+
+std::string UnitTest::ResourceUsage::describe() const {
+   std::stringstream ss;
+   ss << this->minor_faults << " minor and " << this->major_faults << " major faults, "
+      << this->voluntary_switches << " voluntary and " << this->involuntary_switches << " involuntary context switches, "
+      << UnitTest::Utility::format_bytes(double(this->read_bytes)) << " read, "
+      << UnitTest::Utility::format_bytes(double(this->write_bytes)) << " written";
+   return ss.str();
+}
+
+void UnitTest::Resources::set_enabled(bool enabled) {
+   Resources::m_enabled = enabled;
+}
+
+bool UnitTest::Resources::enabled() {
+   return Resources::m_enabled;
+}
+
+UnitTest::ResourceUsage UnitTest::Resources::measure(const std::function<void(void)> &code) {
+
+   ResourceUsage usage;
+   Reading before, after;
+   bool measured = take_reading(before);
+   code();
+   if (!measured || !take_reading(after)) return usage;
+
+   usage.measured = true;
+   usage.minor_faults = difference(after.minor_faults, before.minor_faults);
+   usage.major_faults = difference(after.major_faults, before.major_faults);
+   usage.voluntary_switches = difference(after.voluntary_switches, before.voluntary_switches);
+   usage.involuntary_switches = difference(after.involuntary_switches, before.involuntary_switches);
+   usage.read_bytes = difference(after.read_bytes, before.read_bytes);
+   usage.write_bytes = difference(after.write_bytes, before.write_bytes);
+   return usage;
+}
@@ -0,0 +1,122 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <functional>
+#include <cstdint>
+#include <string>
+
+#ifndef _UNIT_TEST_RESOURCES_HPP_
+#define _UNIT_TEST_RESOURCES_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * The resources of the operating system used while executing some code.
+     **/
+    struct ResourceUsage {
+
+        // It holds whether the resources have been measured.
+        bool measured = false;
+
+        // The page faults served without I/O (e.g. first touch of a page).
+        uint64_t minor_faults = 0;
+
+        // The page faults served reading a page from a device.
+        uint64_t major_faults = 0;
+
+        // The context switches due to waiting (e.g. I/O, locks, sleeps).
+        uint64_t voluntary_switches = 0;
+
+        // The context switches due to preemption.
+        uint64_t involuntary_switches = 0;
+
+        // The bytes read from storage devices.
+        uint64_t read_bytes = 0;
+
+        // The bytes written to storage devices.
+        uint64_t write_bytes = 0;
+
+        /*!
+         * \brief
+         * It describes the usage.
+         *
+         * \returns
+         * See the brief description.
+         */
+        std::string describe() const;
+    };
+
+    /*!
+     * \brief
+     * It measures the resources of the operating system used by code: page faults and context
+     * switches (getrusage) and block I/O (/proc/self/io). On Linux they are the ones of the calling
+     * thread, so that other threads do not disturb them; elsewhere page faults and context switches
+     * are the ones of the process and block I/O is not measured.
+     **/
+    class Resources {
+
+    private:
+
+        // It holds whether the resources of each UT_TEST_CASE are measured and reported.
+        static bool m_enabled;
+
+    public:
+
+        /*!
+         * \brief
+         * It sets whether the resources of each UT_TEST_CASE are measured and reported.
+         *
+         * \param[in] enabled
+         * True to measure and report them.
+         *
+         * \returns
+         * void.
+         */
+        static void set_enabled(bool enabled);
+
+        /*!
+         * \brief
+         * It tells whether the resources of each UT_TEST_CASE are measured and reported.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It measures the resources used while executing code. They are read without allocating
+         * memory, so that allocations measured around code are not disturbed.
+         *
+         * \param[in] code
+         * The code to be measured.
+         *
+         * \returns
+         * See ResourceUsage (not measured where getrusage is not available).
+         */
+        static ResourceUsage measure(const std::function<void(void)> &code);
+    };
+}
+
+#endif // _UNIT_TEST_RESOURCES_HPP_
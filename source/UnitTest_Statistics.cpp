@@ -0,0 +1,96 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#include "UnitTest_Statistics.hpp"
+
+double UnitTest::Statistics::mean(const std::vector<double> &samples) {
+   if (samples.empty()) return 0.0;
+   double sum = 0.0;
+   for (auto it = std::begin(samples); it != std::end(samples); ++it) sum += *it;
+   return sum / samples.size();
+}
+
+double UnitTest::Statistics::stddev(const std::vector<double> &samples) {
+   if (samples.size() < 2) return 0.0;
+   double average = Statistics::mean(samples);
+   double sum = 0.0;
+   for (auto it = std::begin(samples); it != std::end(samples); ++it) sum += (*it - average) * (*it - average);
+   return std::sqrt(sum / (samples.size() - 1));
+}
+
+double UnitTest::Statistics::percentile(std::vector<double> samples, double percentile) {
+   if (samples.empty()) return 0.0;
+   std::sort(samples.begin(), samples.end());
+   double rank = std::min(std::max(percentile, 0.0), 100.0) / 100.0 * (samples.size() - 1);
+   size_t lower = static_cast<size_t>(std::floor(rank));
+   size_t upper = std::min(lower + 1, samples.size() - 1);
+   return samples[lower] + (samples[upper] - samples[lower]) * (rank - lower);
+}
+
+double UnitTest::Statistics::median(const std::vector<double> &samples) {
+   return Statistics::percentile(samples, 50.0);
+}
+
+double UnitTest::Statistics::normal_cdf(double z) {
+   return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+double UnitTest::Statistics::mann_whitney(const std::vector<double> &x, const std::vector<double> &y) {
+
+   if (x.empty() || y.empty()) return 0.0;
+
+   // The samples of both groups are ranked together, tied values get the average of their ranks
+   std::vector<std::pair<double, bool>> values;
+   for (auto it = std::begin(x); it != std::end(x); ++it) values.push_back(std::make_pair(*it, true));
+   for (auto it = std::begin(y); it != std::end(y); ++it) values.push_back(std::make_pair(*it, false));
+   std::sort(values.begin(), values.end());
+
+   double n1 = static_cast<double>(x.size());
+   double n2 = static_cast<double>(y.size());
+   double n = n1 + n2;
+   double rank_sum = 0.0;
+   double ties = 0.0;
+   for (size_t first = 0; first < values.size();) {
+      size_t last = first;
+      while (last + 1 < values.size() && values[last + 1].first == values[first].first) ++last;
+      double rank = (first + last) / 2.0 + 1.0;
+      for (size_t idx = first; idx <= last; ++idx) {
+         if (values[idx].second) rank_sum += rank;
+      }
+      double t = static_cast<double>(last - first + 1);
+      ties += t * t * t - t;
+      first = last + 1;
+   }
+
+   double u = rank_sum - n1 * (n1 + 1.0) / 2.0;
+   double variance = n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+   if (variance <= 0.0) return 0.5;
+
+   double z = (u - n1 * n2 / 2.0 - 0.5) / std::sqrt(variance);
+   return Statistics::normal_cdf(z);
+}
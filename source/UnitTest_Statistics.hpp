@@ -0,0 +1,123 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <vector>
+
+#ifndef _UNIT_TEST_STATISTICS_HPP_
+#define _UNIT_TEST_STATISTICS_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * Class of descriptive statistics over samples.
+     */
+    class Statistics {
+
+    public:
+
+        /*!
+         * \brief
+         * It computes the arithmetic mean of the samples.
+         *
+         * \param[in] samples
+         * The samples.
+         *
+         * \returns
+         * The mean, 0 when there are no samples.
+         */
+        static double mean(const std::vector<double> &samples);
+
+        /*!
+         * \brief
+         * It computes the sample standard deviation of the samples.
+         *
+         * \param[in] samples
+         * The samples.
+         *
+         * \returns
+         * The standard deviation, 0 when there are less than two samples.
+         */
+        static double stddev(const std::vector<double> &samples);
+
+        /*!
+         * \brief
+         * It computes the given percentile of the samples, interpolating linearly between the
+         * closest ranks.
+         *
+         * \param[in] samples
+         * The samples.
+         *
+         * \param[in] percentile
+         * The percentile, between 0 and 100.
+         *
+         * \returns
+         * The percentile, 0 when there are no samples.
+         */
+        static double percentile(std::vector<double> samples, double percentile);
+
+        /*!
+         * \brief
+         * It computes the median of the samples.
+         *
+         * \param[in] samples
+         * The samples.
+         *
+         * \returns
+         * The median, 0 when there are no samples.
+         */
+        static double median(const std::vector<double> &samples);
+
+        /*!
+         * \brief
+         * It computes the cumulative distribution function of the standard normal distribution.
+         *
+         * \param[in] z
+         * The value.
+         *
+         * \returns
+         * The probability that a standard normal variable is lower than z.
+         */
+        static double normal_cdf(double z);
+
+        /*!
+         * \brief
+         * It runs a one-sided Mann-Whitney U test (normal approximation with tie and continuity
+         * corrections) of the hypothesis that the values of x tend to be greater than the ones of y.
+         *
+         * \param[in] x
+         * The first group of samples.
+         *
+         * \param[in] y
+         * The second group of samples.
+         *
+         * \returns
+         * The confidence, between 0 and 1, with which the hypothesis holds (1 - p-value).
+         */
+        static double mann_whitney(const std::vector<double> &x, const std::vector<double> &y);
+    };
+}
+
+#endif
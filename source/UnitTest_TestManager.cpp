@@ -25,6 +25,11 @@ DEALINGS IN THE SOFTWARE.
 #include <unordered_set>
 #include <functional>
 #include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 #include <map>
 
@@ -32,21 +37,39 @@ DEALINGS IN THE SOFTWARE.
 #include "UnitTest_Utility.hpp"
 #include "UnitTest_Console.hpp"
 #include "UnitTest_Requires.hpp"
+#include "UnitTest_Workers.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Baseline.hpp"
+#include "UnitTest_Benchmark.hpp"
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_Durations.hpp"
+#include "UnitTest_Environment.hpp"
+#include "UnitTest_Filter.hpp"
+#include "UnitTest_Profiler.hpp"
+#include "UnitTest_Resources.hpp"
+#include "UnitTest_Timing.hpp"
+#include "UnitTest_Trace.hpp"
 
 // Static member initialization
 UT_TEST_SUITE_LIST_TYPE UnitTest::TestManager::m_cases = UT_TEST_SUITE_LIST_TYPE();
 std::map<std::function<void(void)> *, const char *> UnitTest::TestManager::m_names;
-std::map<std::string, std::unordered_set<std::string>> UnitTest::TestManager::m_tests_tags;
-std::map<const char *, int> UnitTest::TestManager::m_failed;
 std::map<std::string, std::function<void(void)> *> UnitTest::TestManager::m_inits;
 std::map<std::string, std::function<void(void)> *> UnitTest::TestManager::m_cleanup;
-std::unordered_set<std::string> UnitTest::TestManager::m_enabled_tags;
 bool UnitTest::TestManager::m_ret = true;
 bool UnitTest::TestManager::m_filter_suites = false;
 bool UnitTest::TestManager::m_filter_cases = false;
 int UnitTest::TestManager::number_of_cases = 0;
 int UnitTest::TestManager::m_number_of_executed_cases = 0;
-const char *UnitTest::TestManager::current_case = nullptr;
+int UnitTest::TestManager::m_number_of_failed_cases = 0;
+unsigned UnitTest::TestManager::m_threads = 1;
+unsigned UnitTest::TestManager::m_jobs = 1;
+unsigned UnitTest::TestManager::m_shard_count = 1;
+unsigned UnitTest::TestManager::m_shard_index = 0;
+bool UnitTest::TestManager::m_list = false;
+bool UnitTest::TestManager::m_prepared = false;
+std::string UnitTest::TestManager::m_notes;
+std::mutex UnitTest::TestManager::m_notes_mutex;
+thread_local UnitTest::CaseContext *UnitTest::TestManager::m_context = nullptr;
 
 void UnitTest::TestManager::display_error(
    const char *function,
@@ -55,10 +78,15 @@ void UnitTest::TestManager::display_error(
    const char *value,
    bool print) {
 
-   // It counts the number of asserts/requires failed for each case
-   (UnitTest::TestManager::m_failed.count(UnitTest::TestManager::current_case) <= 0) ?
-      UnitTest::TestManager::m_failed[UnitTest::TestManager::current_case] = 0 : // when true
-      UnitTest::TestManager::m_failed[UnitTest::TestManager::current_case] += 1; // when false
+   // It counts the number of asserts/requires failed for the current case
+   CaseContext *context = UnitTest::TestManager::m_context;
+   if (context != nullptr) ++context->failures;
+   UnitTest::Allocations::Pause pause;
+
+   if (UnitTest::Trace::enabled()) {
+      std::string detail = std::string(value) + " at " + (file != nullptr ? file : "") + ":" + std::to_string(line);
+      UnitTest::Trace::instant("failure", function, std::move(detail));
+   }
 
    if (print) { // print is false for unhandled exceptions
 
@@ -77,35 +105,43 @@ void UnitTest::TestManager::display_error(
       ::Console::WriteError(content);
    }
 
-   // It signals the failure of the current tests case
-   TestManager::m_ret = false;
+   // Outside of a case it signals the failure of the whole suite, cases are accounted by record_case
+   if (context == nullptr) TestManager::m_ret = false;
    return;
 }
 
-void UnitTest::TestManager::set_test_case_tags(std::string name, const char *tags) {
-
-   UT_GET_NAME_VECTOR_FROM_VARARGS(vtags, tags);
-   for (auto it = std::begin(vtags); it != std::end(vtags); ++it) {
-      TestManager::m_tests_tags[name].insert(*it);
-   }
-}
-
-bool UnitTest::TestManager::has_tag(std::string test_case) {
+bool UnitTest::TestManager::has_tag(const CaseEntry &test_case) {
 
    // The filtering behaviour has not been required
    if (!TestManager::m_filter_cases) return true;
 
-   // The current test case does not exists
-   if (TestManager::m_tests_tags.count(test_case) <= 0) return false;
+   // Check if the tags of the current test case satisfy the --tags expression
+   return UnitTest::Filter::matches_tags(test_case);
+}
 
-   // Check if the current test case has been tagged with the given tag
-   for (auto it = std::begin(TestManager::m_tests_tags[test_case]);
-        it != std::end(TestManager::m_tests_tags[test_case]); ++it) {
-      if (TestManager::m_enabled_tags.count(*it) > 0)
-         return true;
+void UnitTest::TestManager::prepare() {
+
+   UnitTest::Registry::finalize();
+
+   // When sharding, the enabled cases of each suite are dealt to shards in turn starting from a
+   // shard chosen by the name of the suite: each shard computes the same split on its own and the
+   // number of cases of each suite differs by at most one between shards.
+   std::vector<CaseEntry *> enabled;
+   for (SuiteEntry *suite = UnitTest::Registry::suites(); suite != nullptr; suite = suite->next) {
+      for (CaseEntry *entry = suite->cases; entry != nullptr; entry = entry->next) entry->selected = false;
+      suite->selected = 0;
+
+      UnitTest::Registry::enabled_cases(*suite, enabled);
+      size_t dealt = (TestManager::m_shard_count > 1) ? UnitTest::Utility::hash(suite->name) % TestManager::m_shard_count : 0;
+      for (auto it = std::begin(enabled); it != std::end(enabled); ++it) {
+         if (!UnitTest::TestManager::has_tag(**it) || !UnitTest::Filter::matches_name(*suite, **it)) continue;
+         if (TestManager::m_shard_count > 1 && (dealt++ % TestManager::m_shard_count) != TestManager::m_shard_index) continue;
+         (*it)->selected = true;
+         ++suite->selected;
+      }
    }
 
-   return false;
+   TestManager::m_prepared = true;
 }
 
 void UnitTest::TestManager::enable_test_suite(const char *name, void(*p)()) {
@@ -118,8 +154,8 @@ void UnitTest::TestManager::set_total_number_of_cases(size_t number_of_tests) {
    return;
 }
 
-void UnitTest::TestManager::set_current_case(const char *name) {
-   UnitTest::TestManager::current_case = name;
+void UnitTest::TestManager::set_current_case(CaseContext *context) {
+   UnitTest::TestManager::m_context = context;
    return;
 }
 
@@ -153,40 +189,214 @@ bool UnitTest::TestManager::get_cleanup_method(std::string suite, std::function<
    return false;
 }
 
-void UnitTest::TestManager::run_cases(
+void UnitTest::TestManager::run_case(
+   CaseContext &context,
+   std::function<void()> &test_case,
+   std::function<void()> &cases_init,
+   std::function<void()> &cases_cleanup,
+   const char *file,
    const char *function,
+   long line) {
+
+   auto start = std::chrono::steady_clock::now();
+   UnitTest::TestManager::set_current_case(&context);
+   ::Console::WriteDefault(" TEST CASE -> ");
+   ::Console::WriteDefault(context.name);
+   ::Console::WriteDefault("\n");
+
+   if (cases_init) {
+      UnitTest::Trace::Span span("init", context.name, context.suite);
+      cases_init();
+   }
+
+   // The profiler samples the UT_TEST_CASE alone, so that the frames of the runner stay out of its stacks
+   bool profiled = UnitTest::Profiler::enabled();
+   auto body = [&]() -> void {
+      try { profiled ? UnitTest::Profiler::profile(test_case) : test_case(); }
+      catch (const UnitTest::RequireFailed &) {}
+      catch (...) { UnitTest::TestManager::unhandled_exception(file, function, line); }
+   };
+
+   // Each enabled measurement wraps the body and the measurements enabled before it (they are
+   // built before measuring allocations, since they allocate memory)
+   std::function<void(void)> measured = body;
+   if (UnitTest::Counters::enabled()) measured = [&context, measured]() -> void { context.counters = UnitTest::Counters::measure(measured); };
+   if (UnitTest::Resources::enabled()) measured = [&context, measured]() -> void { context.resources = UnitTest::Resources::measure(measured); };
+   if (UnitTest::Memory::enabled()) measured = [&context, measured]() -> void { context.memory = UnitTest::Memory::measure(measured); };
+
+   // Leaks are the blocks allocated after the init function and still alive after the cleanup one
+   bool leaks = UnitTest::Allocations::leak_checking();
+   if (leaks) UnitTest::Allocations::begin_scope();
+
+   {
+      UnitTest::Trace::Span span("case", context.name, context.suite);
+      UnitTest::AllocationCounters allocations = UnitTest::Allocations::counters();
+      measured();
+      context.allocations = UnitTest::Allocations::counters().allocations - allocations.allocations;
+      context.allocated_bytes = UnitTest::Allocations::counters().allocated_bytes - allocations.allocated_bytes;
+   }
+   if (profiled) UnitTest::Profiler::save(context.suite, context.name);
+
+   if (cases_cleanup) {
+      UnitTest::Trace::Span span("cleanup", context.name, context.suite);
+      cases_cleanup();
+   }
+   if (leaks) UnitTest::TestManager::report_leaks(UnitTest::Allocations::end_scope(), file, line);
+   UnitTest::TestManager::set_current_case(nullptr);
+   context.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void UnitTest::TestManager::report_leaks(const std::vector<Leak> &leaks, const char *file, long line) {
+
+   // The stacks of the largest leaks are enough to find the others
+   static const size_t MAX_REPORTED = 5;
+
+   CaseContext *context = UnitTest::TestManager::m_context;
+   if (leaks.empty() || (context != nullptr && context->failures > 0)) return;
+
+   uint64_t blocks = 0;
+   uint64_t bytes = 0;
+   for (auto it = std::begin(leaks); it != std::end(leaks); ++it) {
+      blocks += it->blocks;
+      bytes += it->bytes;
+   }
+   std::string summary = UnitTest::Utility::format_bytes(double(bytes)) + " in " + std::to_string(blocks) + (blocks > 1 ? " blocks" : " block");
+   UnitTest::TestManager::display_error("Leak", file, line, summary.c_str());
+
+   UnitTest::Allocations::Pause pause;
+   std::stringstream ss;
+   for (size_t idx = 0; idx < leaks.size() && idx < MAX_REPORTED; ++idx) {
+      ss << "    " << UnitTest::Utility::format_bytes(double(leaks[idx].bytes)) << " in " << leaks[idx].blocks << (leaks[idx].blocks > 1 ? " blocks" : " block") << " allocated at" << std::endl;
+      for (auto it = std::begin(leaks[idx].stack); it != std::end(leaks[idx].stack); ++it) ss << "      " << *it << std::endl;
+   }
+   if (leaks.size() > MAX_REPORTED) ss << "    ... and " << (leaks.size() - MAX_REPORTED) << " more call stacks" << std::endl;
+   std::string content = ss.str();
+   ::Console::WriteError(content);
+}
+
+void UnitTest::TestManager::record_case(const CaseContext &context) {
+   if (UnitTest::Durations::enabled())
+      UnitTest::Durations::record(std::string(context.suite) + "." + context.name, context.duration);
+   ++UnitTest::TestManager::m_number_of_executed_cases;
+   std::string memory;
+   if (UnitTest::Allocations::enabled()) {
+      memory = std::to_string(context.allocations) + " allocations, " + UnitTest::Utility::format_bytes(double(context.allocated_bytes));
+      if (UnitTest::Memory::enabled()) memory += ", peak heap " + UnitTest::Utility::format_bytes(double(context.memory.peak_heap));
+   }
+   if (UnitTest::Memory::enabled() && context.memory.resident_measured) {
+      memory += std::string(memory.empty() ? "" : ", ") + "peak RSS " + UnitTest::Utility::format_bytes(double(context.memory.peak_resident)) +
+                " (+" + UnitTest::Utility::format_bytes(double(context.memory.peak_resident_growth)) + ")";
+   }
+   if (!memory.empty()) UnitTest::TestManager::add_note(std::string(context.name) + ": " + memory);
+   if (context.counters.measured) UnitTest::TestManager::add_note(std::string(context.name) + ": " + context.counters.describe());
+   if (context.resources.measured) UnitTest::TestManager::add_note(std::string(context.name) + ": " + context.resources.describe());
+   if (context.failures == 0 && !context.concurrent)
+      UnitTest::Baseline::executed(std::string(context.suite) + "." + context.name);
+   if (context.failures > 0) {
+      ++UnitTest::TestManager::m_number_of_failed_cases;
+      UnitTest::TestManager::m_ret = false;
+   }
+}
+
+void UnitTest::TestManager::run_cases(
+   const SuiteEntry &suite,
    const char *file,
    long line,
-   std::function<void()> *cases,
-   std::vector<std::string> &names) {
+   TestCase *cases,
+   size_t count) {
+
+   if (!UnitTest::TestManager::m_prepared) UnitTest::TestManager::prepare();
+
+   // A typed UT_TEST_CASE stands for all its instances
+   std::vector<TestCase> instances;
+   for (size_t idx = 0; idx < count; ++idx) {
+      if (cases[idx].instances() != nullptr) instances.insert(instances.end(), cases[idx].instances()->begin(), cases[idx].instances()->end());
+      else instances.push_back(cases[idx]);
+   }
+   cases = instances.data();
+   count = instances.size();
 
-   UnitTest::TestManager::set_total_number_of_cases(names.size());
+   const char *function = suite.name;
+   UnitTest::TestManager::set_total_number_of_cases(count);
    UnitTest::TestManager::m_number_of_executed_cases = 0;
+   UnitTest::TestManager::m_number_of_failed_cases = 0;
    std::function<void(void)> cases_init;
    std::function<void(void)> cases_cleanup;
+   UnitTest::TestManager::get_init_method(function, cases_init);
+   UnitTest::TestManager::get_cleanup_method(function, cases_cleanup);
+
+   // It keeps the cases selected by prepare, in the order they have been enabled
+   std::vector<size_t> selected;
+   for (size_t idx = 0; idx < count; ++idx) {
+      if (cases[idx].entry().selected) selected.push_back(idx);
+   }
+
+   std::vector<CaseContext> contexts(selected.size());
+   for (size_t idx = 0; idx < selected.size(); ++idx) {
+      contexts[idx].suite = function;
+      contexts[idx].name = cases[selected[idx]].entry().name;
+   }
+
+   // Exceptions thrown by the init and cleanup functions are credited to the case, which is no
+   // longer the current one afterwards (its context does not outlive the suite)
+   auto execute = [&](size_t idx) -> void {
+      try {
+         UnitTest::TestManager::run_case(
+            contexts[idx], cases[selected[idx]].body(), cases_init, cases_cleanup, file, function, line);
+      }
+      catch (...) {
+         UnitTest::TestManager::unhandled_exception(file, function, line);
+         UnitTest::TestManager::set_current_case(nullptr);
+      }
+   };
 
-   unsigned int f_it = 0;
-   auto n_it = std::begin(names);
-   while (n_it != std::end(names)) {
-      if (!UnitTest::TestManager::has_tag(*n_it)) {
-         ++f_it, ++n_it;
-         continue;
+   if (UnitTest::TestManager::m_threads <= 1 || selected.size() <= 1) {
+      for (size_t idx = 0; idx < selected.size(); ++idx) {
+         execute(idx);
+         UnitTest::TestManager::record_case(contexts[idx]);
       }
-      ::Console::WriteDefault(" TEST CASE -> ");
-      ::Console::WriteDefault(*n_it);
-      ::Console::WriteDefault("\n");
-      UnitTest::TestManager::set_current_case((*n_it).c_str());
+      return;
+   }
 
-      if (UnitTest::TestManager::get_init_method(function, cases_init)) cases_init();
+   // Cases are started from the longest one, so that a long case started last does not delay the suite
+   std::vector<std::string> keys;
+   for (size_t idx = 0; idx < contexts.size(); ++idx) keys.push_back(std::string(function) + "." + contexts[idx].name);
+   std::vector<size_t> order = UnitTest::Durations::longest_first(keys);
+
+   // Exclusive cases (e.g. UT_BENCHMARKs) are executed alone, once all the others are over
+   std::vector<size_t> shared;
+   std::vector<size_t> exclusive;
+   for (auto it = std::begin(order); it != std::end(order); ++it)
+      (cases[selected[*it]].entry().exclusive ? exclusive : shared).push_back(*it);
+   for (auto it = std::begin(shared); it != std::end(shared); ++it) contexts[*it].concurrent = shared.size() > 1;
+
+   // Each worker takes the next case to be executed, its output is buffered in the case context
+   std::atomic<size_t> next(0);
+   const std::vector<size_t> *queue = &shared;
+   auto worker = [&]() -> void {
+      for (size_t position = next++; position < queue->size(); position = next++) {
+         size_t idx = (*queue)[position];
+         ::Console::SetStream(&contexts[idx].output);
+         execute(idx);
+         ::Console::SetStream(nullptr);
+      }
+   };
 
-      try { cases[f_it](); }
-      catch (UnitTest::RequireFailed) {}
-      catch (...) { UnitTest::TestManager::unhandled_exception(file, function, line); }
-      ++UnitTest::TestManager::m_number_of_executed_cases;
+   size_t workers = std::min<size_t>(UnitTest::TestManager::m_threads, shared.size());
+   std::vector<std::thread> pool;
+   for (size_t idx = 0; idx < workers; ++idx) pool.push_back(std::thread(worker));
+   for (auto it = std::begin(pool); it != std::end(pool); ++it) it->join();
 
-      if (UnitTest::TestManager::get_cleanup_method(function, cases_cleanup)) cases_cleanup();
+   if (!exclusive.empty()) {
+      next = 0;
+      queue = &exclusive;
+      std::thread(worker).join();
+   }
 
-      ++f_it, ++n_it;
+   // The output of the cases is written in their enabling order
+   for (size_t idx = 0; idx < contexts.size(); ++idx) {
+      ::Console::WriteRaw(contexts[idx].output.str());
+      UnitTest::TestManager::record_case(contexts[idx]);
    }
 }
 
@@ -226,14 +436,14 @@ void UnitTest::TestManager::write_suite_footer() {
 	};
 
 	static auto write_failed = [&]()->void{
-		 ss << std::setw(10) << std::right << "Failed: " << std::setw(5) << std::left << UnitTest::TestManager::m_failed.size();
+		 ss << std::setw(10) << std::right << "Failed: " << std::setw(5) << std::left << UnitTest::TestManager::m_number_of_failed_cases;
 		 content = ss.str();
 		 Console::WriteError(content);
 		 ss.str("");
 	};
 
 	static auto write_passed = [&]()->void{
-		 ss << std::setw(10) << std::right << "Passed: " << std::setw(5) << std::left << UnitTest::TestManager::m_number_of_executed_cases - UnitTest::TestManager::m_failed.size();
+		 ss << std::setw(10) << std::right << "Passed: " << std::setw(5) << std::left << UnitTest::TestManager::m_number_of_executed_cases - UnitTest::TestManager::m_number_of_failed_cases;
 		 content = ss.str();
 		 Console::Write(content);
 		 ss.str("");
@@ -251,6 +461,11 @@ void UnitTest::TestManager::write_suite_footer() {
 	write_passed();
 	write_total();
 
+	if (!UnitTest::TestManager::m_notes.empty()) {
+		Console::Write("\n");
+		Console::WriteDefault(UnitTest::TestManager::m_notes);
+	}
+
 	std::cout << std::endl << std::endl;
 	return;
 }
@@ -260,9 +475,33 @@ void UnitTest::TestManager::run(int argc, char **argv) {
 	const char *LINE = "--------------------------------------------------------------------------";
 	const char *ARG_SUITES = "--suites";
 	const char *ARG_TAGS = "--tags";
+	const char *ARG_FILTER = "--filter";
+	const char *ARG_THREADS = "--threads";
+	const char *ARG_JOBS = "--jobs";
+	const char *ARG_DURATIONS = "--durations";
+	const char *ARG_SHARD_COUNT = "--shard-count";
+	const char *ARG_SHARD_INDEX = "--shard-index";
+	const char *ARG_LIST = "--list";
+	const char *ARG_LEAKS = "--leaks";
+	const char *ARG_MEMORY = "--memory";
+	const char *ARG_PERF_COUNTERS = "--perf-counters";
+	const char *ARG_RUSAGE = "--rusage";
+	const char *ARG_PROFILE = "--profile";
+	const char *ARG_PROFILE_THRESHOLD = "--profile-threshold";
+	const char *ARG_TRACE = "--trace";
+	const char *ARG_BENCHMARK_SAMPLES = "--benchmark-samples";
+	const char *ARG_BENCHMARK_MIN_TIME = "--benchmark-min-time";
+	const char *ARG_BENCHMARK_OUT = "--benchmark-out";
+	const char *ARG_BENCHMARK_COLD = "--benchmark-cold";
+	const char *ARG_BENCHMARK_CPUS = "--benchmark-cpus";
+	const char *ARG_BENCHMARK_PRIORITY = "--benchmark-priority";
+	const char *ARG_TIMING_SAMPLES = "--timing-samples";
+	const char *ARG_SAVE_BASELINE = "--save-baseline";
+	const char *ARG_COMPARE_BASELINE = "--compare-baseline";
+	const char *ARG_BASELINE_TOLERANCE = "--baseline-tolerance";
 	const char *ARROW = "------------------------------------------------------------------------->";
 
-	auto AcquireFollowers = [](char **argv, int idx, int limit, std::unordered_set<std::string> &follower) -> void {
+	auto AcquireFollowers = [](char **argv, int idx, int limit, std::vector<std::string> &follower) -> void {
 
 		 std::string current;
 
@@ -270,13 +509,15 @@ void UnitTest::TestManager::run(int argc, char **argv) {
 			 if (idx == limit) break;
 			 current = argv[idx];
 			 if ((current.length() > 0 && current.at(0) == '-') || current == "") break;
-			 follower.insert(current);
+			 follower.push_back(current);
 			 ++idx;
 		 }
 	};
 
 
-	std::unordered_set<std::string> enabled_suites;
+	std::vector<std::string> enabled_suites;
+	std::vector<std::string> tags;
+	std::vector<std::string> patterns;
 	for (int idx = 1; idx < argc; ++idx) {
 		std::string current = argv[idx];
 
@@ -287,29 +528,254 @@ void UnitTest::TestManager::run(int argc, char **argv) {
 
 		if (current == ARG_TAGS) {
 			TestManager::m_filter_cases = true;
-			AcquireFollowers(argv, ++idx, argc, TestManager::m_enabled_tags);
+			AcquireFollowers(argv, ++idx, argc, tags);
+		}
+
+		if (current == ARG_FILTER) {
+			AcquireFollowers(argv, ++idx, argc, patterns);
+		}
+
+		if (current == ARG_THREADS && idx + 1 < argc) {
+			int threads = std::atoi(argv[++idx]);
+			TestManager::m_threads = (threads > 1) ? static_cast<unsigned>(threads) : 1;
+		}
+
+		if (current == ARG_JOBS && idx + 1 < argc) {
+			int jobs = std::atoi(argv[++idx]);
+			TestManager::m_jobs = (jobs > 1) ? static_cast<unsigned>(jobs) : 1;
+		}
+
+		if (current == ARG_DURATIONS && idx + 1 < argc) {
+			if (!UnitTest::Durations::load(argv[++idx])) {
+				std::string error = "Invalid durations file, measured durations will start from scratch\n";
+				::Console::WriteError(error);
+			}
+		}
+
+		if (current == ARG_SHARD_COUNT && idx + 1 < argc) {
+			int count = std::atoi(argv[++idx]);
+			TestManager::m_shard_count = (count > 1) ? static_cast<unsigned>(count) : 1;
+		}
+
+		if (current == ARG_SHARD_INDEX && idx + 1 < argc) {
+			int index = std::atoi(argv[++idx]);
+			TestManager::m_shard_index = (index > 0) ? static_cast<unsigned>(index) : 0;
+		}
+
+		if (current == ARG_LIST) {
+			TestManager::m_list = true;
+		}
+
+		if (current == ARG_LEAKS) {
+			if (!UnitTest::Allocations::enabled()) {
+				std::string error = "Leaks cannot be checked without UT_TRACK_ALLOCATIONS()\n";
+				::Console::WriteError(error);
+			}
+			UnitTest::Allocations::set_leak_checking(true);
+		}
+
+		if (current == ARG_MEMORY) {
+			UnitTest::Memory::set_enabled(true);
+		}
+
+		if (current == ARG_PERF_COUNTERS) {
+			UnitTest::Counters::set_enabled(true);
+		}
+
+		if (current == ARG_RUSAGE) {
+			UnitTest::Resources::set_enabled(true);
+		}
+
+		if (current == ARG_PROFILE && idx + 1 < argc) {
+			UnitTest::Profiler::set_directory(argv[++idx]);
+		}
+
+		if (current == ARG_PROFILE_THRESHOLD && idx + 1 < argc) {
+			UnitTest::Profiler::set_threshold(std::atof(argv[++idx]));
+		}
+
+		if (current == ARG_TRACE && idx + 1 < argc) {
+			UnitTest::Trace::set_output(argv[++idx]);
+		}
+
+		if (current == ARG_BENCHMARK_SAMPLES && idx + 1 < argc) {
+			int samples = std::atoi(argv[++idx]);
+			UnitTest::Benchmark::set_samples((samples > 1) ? static_cast<unsigned>(samples) : 1);
+		}
+
+		if (current == ARG_BENCHMARK_MIN_TIME && idx + 1 < argc) {
+			UnitTest::Benchmark::set_min_time(std::atof(argv[++idx]));
+		}
+
+		if (current == ARG_BENCHMARK_OUT && idx + 1 < argc) {
+			UnitTest::Benchmark::set_output(argv[++idx]);
+		}
+
+		if (current == ARG_BENCHMARK_COLD && idx + 1 < argc) {
+			UnitTest::Benchmark::set_cold(std::atof(argv[++idx]));
+		}
+
+		if (current == ARG_BENCHMARK_CPUS) {
+			std::vector<std::string> values;
+			AcquireFollowers(argv, ++idx, argc, values);
+			std::vector<unsigned> cpus;
+			for (auto it = std::begin(values); it != std::end(values); ++it) cpus.push_back(static_cast<unsigned>(std::atoi(it->c_str())));
+			UnitTest::Environment::set_cpus(cpus);
+		}
+
+		if (current == ARG_BENCHMARK_PRIORITY) {
+			UnitTest::Environment::set_priority(true);
+		}
+
+		if (current == ARG_TIMING_SAMPLES && idx + 1 < argc) {
+			int samples = std::atoi(argv[++idx]);
+			UnitTest::Timing::set_samples((samples > 1) ? static_cast<unsigned>(samples) : 1);
+		}
+
+		if (current == ARG_SAVE_BASELINE && idx + 1 < argc) {
+			UnitTest::Baseline::save_to(argv[++idx]);
+		}
+
+		if (current == ARG_COMPARE_BASELINE && idx + 1 < argc) {
+			if (!UnitTest::Baseline::compare_with(argv[++idx])) {
+				std::string error = "Invalid baseline file, results will not be compared\n";
+				::Console::WriteError(error);
+			}
+		}
+
+		if (current == ARG_BASELINE_TOLERANCE && idx + 1 < argc) {
+			UnitTest::Baseline::set_tolerance(std::atof(argv[++idx]));
 		}
 	}
 
-	UT_TEST_SUITE_LIST_TYPE_ITERATOR it = std::begin(UnitTest::TestManager::m_cases);
 	::Console::InitConsole();
-	for (; it != std::end(UnitTest::TestManager::m_cases); ++it) {
+	if (TestManager::m_shard_index >= TestManager::m_shard_count) {
+		std::string error = "The shard index must be lower than the shard count\n";
+		::Console::WriteError(error);
+		return;
+	}
+
+	// The tag expression is compiled once tags have been interned
+	UnitTest::Registry::finalize();
+	if (TestManager::m_filter_cases) {
+		std::string expression, error;
+		for (auto it = std::begin(tags); it != std::end(tags); ++it) expression += (it == std::begin(tags) ? "" : " ") + *it;
+		if (!UnitTest::Filter::set_tags(expression, error)) {
+			error = "Invalid --tags: " + error + "\n";
+			::Console::WriteError(error);
+			return;
+		}
+	}
+	for (auto it = std::begin(patterns); it != std::end(patterns); ++it) UnitTest::Filter::add_pattern(*it);
 
+	// It selects the suites to be executed keeping their registration order
+	std::vector<size_t> suites;
+	for (size_t idx = 0; idx < UnitTest::TestManager::m_cases.size(); ++idx) {
 		if (TestManager::m_filter_suites) {
-			if (enabled_suites.count(std::get<0>(*it)) == 0)
+			if (std::find(std::begin(enabled_suites), std::end(enabled_suites), std::get<0>(UnitTest::TestManager::m_cases[idx])) == std::end(enabled_suites))
 				continue;
 		}
+		suites.push_back(idx);
+	}
+
+	UnitTest::TestManager::prepare();
+
+	// When sharding or filtering by name, suites having no selected case are not executed at all
+	if (TestManager::m_shard_count > 1 || UnitTest::Filter::has_patterns()) {
+		std::vector<size_t> sharded;
+		for (auto it = std::begin(suites); it != std::end(suites); ++it) {
+			SuiteEntry *entry = UnitTest::Registry::find(std::get<0>(UnitTest::TestManager::m_cases[*it]));
+			if (entry == nullptr || entry->selected > 0) sharded.push_back(*it);
+		}
+		suites.swap(sharded);
+	}
 
-		write_suite_header(std::get<0>(*it));
-		try { std::get<1>(*it)(); }
-		catch (...) { m_ret = false; }
-		write_suite_footer();
+	if (TestManager::m_list) {
+		std::vector<CaseEntry *> enabled;
+		for (auto it = std::begin(suites); it != std::end(suites); ++it) {
+			::Console::WriteRaw(std::string(std::get<0>(UnitTest::TestManager::m_cases[*it])) + "\n");
+			SuiteEntry *entry = UnitTest::Registry::find(std::get<0>(UnitTest::TestManager::m_cases[*it]));
+			if (entry == nullptr) continue;
+
+			UnitTest::Registry::enabled_cases(*entry, enabled);
+			for (auto test_case = std::begin(enabled); test_case != std::end(enabled); ++test_case) {
+				if (!(*test_case)->selected) continue;
+
+				const char *token = nullptr;
+				size_t length = 0;
+				std::stringstream ss;
+				ss << "  " << (*test_case)->name;
+				bool first = true;
+				for (const char *tag = UnitTest::Registry::next_token((*test_case)->tags, token, length); tag != nullptr;
+					  tag = UnitTest::Registry::next_token(tag, token, length), first = false) {
+					ss << (first ? " [" : ", ");
+					ss.write(token, static_cast<std::streamsize>(length));
+				}
+				ss << (first ? "" : "]") << std::endl;
+				::Console::WriteRaw(ss.str());
+			}
+		}
+		return;
+	}
 
-		// It cleans variables used to track UT_TEST_CASE's execution.
-		UnitTest::TestManager::number_of_cases = 0;
-		UnitTest::TestManager::m_failed.clear();
-		m_ret = true;
+	if (TestManager::m_jobs > 1 && UnitTest::Workers::available()) {
+		UnitTest::Workers::run(suites, TestManager::m_jobs);
+	}
+	else {
+		for (auto it = std::begin(suites); it != std::end(suites); ++it) {
+			write_suite_header(std::get<0>(UnitTest::TestManager::m_cases[*it]));
+			execute_suite(*it);
+			write_suite_footer();
+			reset_suite();
+		}
 	}
+
+	if (UnitTest::Durations::enabled() && !UnitTest::Durations::save()) {
+		std::string error = "Unable to write the durations file\n";
+		::Console::WriteError(error);
+	}
+
+	if (!UnitTest::Benchmark::save(argc > 0 ? argv[0] : nullptr)) {
+		std::string error = "Unable to write the benchmark results file\n";
+		::Console::WriteError(error);
+	}
+
+	if (!UnitTest::Baseline::save()) {
+		std::string error = "Unable to write the baseline file\n";
+		::Console::WriteError(error);
+	}
+
+	if (!UnitTest::Trace::save()) {
+		std::string error = "Unable to write the trace file\n";
+		::Console::WriteError(error);
+	}
+}
+
+void UnitTest::TestManager::execute_suite(size_t index) {
+	auto start = std::chrono::steady_clock::now();
+	UnitTest::Trace::Span span("suite", std::get<0>(UnitTest::TestManager::m_cases[index]));
+	try { std::get<1>(UnitTest::TestManager::m_cases[index])(); }
+	catch (...) { m_ret = false; }
+	if (UnitTest::Durations::enabled()) {
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		UnitTest::Durations::record(std::get<0>(UnitTest::TestManager::m_cases[index]), elapsed);
+	}
+}
+
+void UnitTest::TestManager::reset_suite() {
+
+	// It cleans variables used to track UT_TEST_CASE's execution.
+	UnitTest::TestManager::number_of_cases = 0;
+	UnitTest::TestManager::m_number_of_executed_cases = 0;
+	UnitTest::TestManager::m_number_of_failed_cases = 0;
+	UnitTest::TestManager::m_notes.clear();
+	m_ret = true;
+}
+
+void UnitTest::TestManager::add_note(const std::string &note) {
+	UnitTest::Allocations::Pause pause;
+	std::lock_guard<std::mutex> lock(UnitTest::TestManager::m_notes_mutex);
+	UnitTest::TestManager::m_notes += "  " + note + "\n";
 }
 
 void UnitTest::TestManager::run() {
@@ -24,12 +24,21 @@ DEALINGS IN THE SOFTWARE.
 
 #include <unordered_set>
 #include <functional>
+#include <atomic>
 #include <sstream>
+#include <thread>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <tuple>
 #include <map>
 
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Counters.hpp"
+#include "UnitTest_Memory.hpp"
+#include "UnitTest_Registry.hpp"
+#include "UnitTest_Resources.hpp"
+
 #ifndef _UNIT_TEST_MANAGER_HPP_
 #define _UNIT_TEST_MANAGER_HPP_
 
@@ -48,26 +57,43 @@ DEALINGS IN THE SOFTWARE.
 // The type used as iterator for the list of UT_TEST_SUITE descriptors
 #define UT_TEST_SUITE_LIST_TYPE_ITERATOR std::vector<UT_TEST_SUITE_DESCRIPTOR_TYPE>::iterator
 
-// UT_TEST_SUITE declaration
-#define UT_TEST_SUITE(SUITE) void SUITE()
+// UT_TEST_SUITE declaration. The suite is a function template whose only (defaulted) parameter
+// describes the suite, so that the macros used in its body can refer to it as ut_suite_t.
+#define UT_TEST_SUITE(SUITE) \
+   struct SUITE##_ut_suite { \
+      static constexpr const char *name() { return #SUITE; } \
+      static constexpr const char *file() { return __FILE__; } \
+   }; \
+   template<typename ut_suite_t = SUITE##_ut_suite> void SUITE()
 
 // UT_TEST_CASE declaration where:
 //		CASE is the name to assign to the UT_TEST_CASE
 //		__VA_ARGS__ is the list of words to use to tag the UT_TEST_CASE
 // 	NOTE: When __VA_ARGS__ is empty the comma after the name is mandatory
-#define UT_TEST_CASE(CASE, ...) UnitTest::TestManager::set_test_case_tags(UT_COMPILE_TIME_STRING(CASE), #__VA_ARGS__); std::function<void(void)> CASE = [&]()->void
+//	Name and tags are recorded in a static table at compile time, see UnitTest::Registry.
+#define UT_TEST_CASE(CASE, ...) \
+   struct CASE##_ut_case { \
+      static constexpr const char *name() { return #CASE; } \
+      static constexpr const char *tags() { return #__VA_ARGS__; } \
+      static constexpr long line() { return __LINE__; } \
+      static constexpr bool exclusive() { return false; } \
+   }; \
+   UnitTest::TestCase CASE = UnitTest::TestCase(UnitTest::CaseRegistrar<ut_suite_t, CASE##_ut_case>::get()) = [&]()->void
 
 // Declaration of the initialization function of all UT_TEST_CASE of a UT_TEST_SUITE
-#define UT_TEST_CASE_INIT() std::function<void(void)> _init; UnitTest::TestManager::set_init_method(__FUNCTION__, _init); _init = [&]()->void
+#define UT_TEST_CASE_INIT() std::function<void(void)> _init; UnitTest::TestManager::set_init_method(ut_suite_t::name(), _init); _init = [&]()->void
 
 // Declaration fo the cleanup function of all UT_TEST_CASE of a UT_TEST_SUITE
-#define UT_TEST_CASE_CLEANUP() std::function<void(void)> _cleanup; UnitTest::TestManager::set_cleanup_method(__FUNCTION__, _cleanup); _cleanup = [&]()->void
+#define UT_TEST_CASE_CLEANUP() std::function<void(void)> _cleanup; UnitTest::TestManager::set_cleanup_method(ut_suite_t::name(), _cleanup); _cleanup = [&]()->void
 
 // It creates a vector V containing all comma separated values in the ARGS string
 #define UT_GET_NAME_VECTOR_FROM_VARARGS(V, ARGS) std::vector<std::string> V; UnitTest::Utility::split(ARGS,',', V);
 
-// It enables each UT_TEST_CASE named in the CSV string __VA_ARGS__
-#define UT_ENABLE_TEST_CASES(...) UT_GET_NAME_VECTOR_FROM_VARARGS(___ns, #__VA_ARGS__); std::function<void(void)> ___cs [] = {__VA_ARGS__}; UnitTest::TestManager::run_cases(__FUNCTION__, __FILE__, __LINE__, ___cs , ___ns);
+// It enables each UT_TEST_CASE named in the CSV string __VA_ARGS__ (the names are recorded in a static table)
+#define UT_ENABLE_TEST_CASES(...) \
+   struct ut_enabled_cases { static constexpr const char *names() { return #__VA_ARGS__; } }; \
+   UnitTest::TestCase ___cs [] = {__VA_ARGS__}; \
+   UnitTest::TestManager::run_cases(UnitTest::EnableRegistrar<ut_suite_t, ut_enabled_cases>::get(), __FILE__, __LINE__, ___cs, sizeof(___cs) / sizeof(___cs[0]));
 
 // It requires a UT_TEST_SUITE execution
 #define UT_REGISTER_TEST_SUITE(X) UnitTest::TestManager::enable_test_suite(UT_COMPILE_TIME_STRING(X), X)
@@ -81,6 +107,58 @@ DEALINGS IN THE SOFTWARE.
 
 namespace UnitTest {
 
+    /*!
+     * \brief
+     * It holds the state of a single UT_TEST_CASE execution. Each UT_TEST_CASE owns
+     * its own context so that failures and console output are always credited to the
+     * right UT_TEST_CASE, even when several of them run at the same time.
+     **/
+    struct CaseContext {
+
+        // The name of the UT_TEST_SUITE of the UT_TEST_CASE.
+        const char *suite = nullptr;
+
+        // The name of the UT_TEST_CASE.
+        const char *name = nullptr;
+
+        // The number of asserts/requires failed in the UT_TEST_CASE (also by the threads it starts).
+        std::atomic<int> failures{0};
+
+        // It tells whether other UT_TEST_CASEs may run at the same time (--threads), disturbing its timings.
+        bool concurrent = false;
+
+        // It holds whether the footer of the suite tells that the timings of the UT_TEST_CASE are disturbed
+        // (threads started by the UT_TEST_CASE may time code at the same time).
+        std::atomic<bool> disturbance_noted{false};
+
+        // The wall time, in seconds, spent executing the UT_TEST_CASE with its init and cleanup.
+        double duration = 0.0;
+
+        // The tolerance, in percent, of the comparison with the baseline (negative for the global one).
+        double tolerance = -1.0;
+
+        // The number of results of the UT_TEST_CASE recorded for the baseline, they are numbered in order.
+        std::atomic<unsigned> baseline_results{0};
+
+        // The number of heap allocations performed by the body of the UT_TEST_CASE (see UT_TRACK_ALLOCATIONS).
+        uint64_t allocations = 0;
+
+        // The memory, in bytes, allocated by the body of the UT_TEST_CASE.
+        uint64_t allocated_bytes = 0;
+
+        // The peak memory of the body of the UT_TEST_CASE (measured with --memory).
+        MemoryUsage memory = MemoryUsage();
+
+        // The hardware events counted by the body of the UT_TEST_CASE (measured with --perf-counters).
+        CounterValues counters;
+
+        // The resources of the operating system used by the body of the UT_TEST_CASE (measured with --rusage).
+        ResourceUsage resources;
+
+        // The console output of the UT_TEST_CASE when it is executed by a worker thread.
+        std::stringstream output;
+    };
+
     /*!
      * \brief
      * It enables execution and management of UT_TEST_SUITE and UT_TEST_CASE.
@@ -95,11 +173,6 @@ namespace UnitTest {
         // It holds the names of all UT_TEST_CASEs.
         static std::map<std::function<void(void)> *, const char *> m_names;
 
-        // It holds the tags of all UT_TEST_CASEs.
-        static std::map<std::string, std::unordered_set<std::string>> m_tests_tags;
-
-        // It holds the name of all failed UT_TEST_CASEs.
-        static std::map<const char *, int> m_failed;
 
         // It tracks which UT_TEST_SUITE has a UT_INIT_TEST_CASE method.
         static std::map<std::string, std::function<void(void)> *> m_inits;
@@ -107,9 +180,6 @@ namespace UnitTest {
         // It tracks which UT_TEST_SUITE has a UT_CLEANUP_CASE method.
         static std::map<std::string, std::function<void(void)> *> m_cleanup;
 
-        // It holds all enabled tags.
-        static std::unordered_set<std::string> m_enabled_tags;
-
         // Used to tell whether one or more UT_TEST_CASES have been failed in a UT_TEST_SUITE.
         static bool m_ret;
 
@@ -125,8 +195,35 @@ namespace UnitTest {
         // It stores the number of UT_TEST_CASEs executed in the current UT_TEST_SUITE.
         static int m_number_of_executed_cases;
 
-        // It holds the name of the UT_TEST_CASE currently in execution.
-        static const char *current_case;
+        // It stores the number of UT_TEST_CASEs failed in the current UT_TEST_SUITE.
+        static int m_number_of_failed_cases;
+
+        // It holds the number of worker threads used to execute the UT_TEST_CASEs of a UT_TEST_SUITE.
+        static unsigned m_threads;
+
+        // It holds the number of worker processes used to execute the UT_TEST_SUITEs.
+        static unsigned m_jobs;
+
+        // It holds the number of shards in which UT_TEST_CASEs are split across runners.
+        static unsigned m_shard_count;
+
+        // It holds the index of the shard whose UT_TEST_CASEs must be executed.
+        static unsigned m_shard_index;
+
+        // It holds whether UT_TEST_CASEs must be listed instead of executed.
+        static bool m_list;
+
+        // It holds whether the UT_TEST_CASEs to be executed have been selected.
+        static bool m_prepared;
+
+        // It holds the notes to be written in the footer of the current UT_TEST_SUITE, one per line.
+        static std::string m_notes;
+
+        // It protects the notes, they can be added by the threads executing UT_TEST_CASEs.
+        static std::mutex m_notes_mutex;
+
+        // It holds the context of the UT_TEST_CASE executing on the calling thread.
+        static thread_local CaseContext *m_context;
 
         // Used to establish that the Asserts class can have access to private members of the current class.
         friend class Asserts;
@@ -134,6 +231,30 @@ namespace UnitTest {
         // Used to establish that the Requires class can have access to private members of the current class.
         friend class Requires;
 
+        // Used to establish that the Workers class can have access to private members of the current class.
+        friend class Workers;
+
+        // Used to establish that the Benchmark class can have access to private members of the current class.
+        friend class Benchmark;
+
+        // Used to establish that the Baseline class can have access to private members of the current class.
+        friend class Baseline;
+
+        // Used to establish that the TypedMatrix class can have access to private members of the current class.
+        friend class TypedMatrix;
+
+        // Used to establish that the Memory class can have access to private members of the current class.
+        friend class Memory;
+
+        // Used to establish that the Profiler class can have access to private members of the current class.
+        friend class Profiler;
+
+        // Used to establish that the LoadGen class can have access to private members of the current class.
+        friend class LoadGen;
+
+        // Used to establish that the Timing class can have access to private members of the current class.
+        friend class Timing;
+
 
         /*!
          * \brief
@@ -157,30 +278,106 @@ namespace UnitTest {
         static void display_error(const char *function, const char *file, long line, const char *value,
                                   bool print = true);
 
-    public:
+        /*!
+         * \brief
+         * It executes a single UT_TEST_CASE, surrounded by its init and cleanup functions, on
+         * the calling thread crediting its failures to the given context.
+         *
+         * \param[in] context
+         * The context of the UT_TEST_CASE.
+         *
+         * \param[in] test_case
+         * The UT_TEST_CASE to be executed.
+         *
+         * \param[in] cases_init
+         * The init function of the UT_TEST_SUITE (it may be empty).
+         *
+         * \param[in] cases_cleanup
+         * The cleanup function of the UT_TEST_SUITE (it may be empty).
+         *
+         * \param[in] file
+         * The full path of the file in which the UT_TEST_SUITE has been defined.
+         *
+         * \param[in] function
+         * The name of the UT_TEST_SUITE.
+         *
+         * \param[in] line
+         * The line in which the UT_TEST_SUITE has been defined.
+         *
+         * \returns
+         * void.
+         */
+        static void run_case(
+           CaseContext &context,
+           std::function<void()> &test_case,
+           std::function<void()> &cases_init,
+           std::function<void()> &cases_cleanup,
+           const char *file,
+           const char *function,
+           long line
+        );
 
         /*!
          * \brief
-         * It maps the test case dubbed name, with tags contained in tags.
+         * It fails the current UT_TEST_CASE for the given leaks, writing their call stacks. Cases
+         * already failed are not charged, since a failed Require leaves their work half done.
          *
-         * \param[in] name
-         * The name of the UT_TEST_CASE.
+         * \param[in] leaks
+         * The leaks of the case, as returned by Allocations::end_scope.
+         *
+         * \param[in] file
+         * The file enabling the UT_TEST_CASE.
          *
-         * \param[in] tags
-         * The CSV string of tags.
+         * \param[in] line
+         * The line enabling the UT_TEST_CASE.
          *
          * \returns
-         * Void.
-         **/
-        static void set_test_case_tags(std::string name, const char *tags);
+         * void.
+         */
+        static void report_leaks(const std::vector<Leak> &leaks, const char *file, long line);
+
+        /*!
+         * \brief
+         * It accounts the outcome of an executed UT_TEST_CASE in the current UT_TEST_SUITE.
+         *
+         * \param[in] context
+         * The context of the executed UT_TEST_CASE.
+         *
+         * \returns
+         * void.
+         */
+        static void record_case(const CaseContext &context);
+
+        /*!
+         * \brief
+         * It executes the registered UT_TEST_SUITE at the given index, leaving its outcome in the
+         * variables used to track UT_TEST_CASE's execution.
+         *
+         * \param[in] index
+         * The index of the UT_TEST_SUITE in the list of registered UT_TEST_SUITEs.
+         *
+         * \returns
+         * void.
+         */
+        static void execute_suite(size_t index);
+
+        /*!
+         * \brief
+         * It cleans the variables used to track UT_TEST_CASE's execution in the current UT_TEST_SUITE.
+         *
+         * \returns
+         * void.
+         */
+        static void reset_suite();
+
+    public:
 
         /*!
         * \brief
-        * It returns a boolean value indicating whether the UT_TEST_CASE whose name is the
-        * value of test_case variable must be executed or not.
+        * It returns a boolean value indicating whether the given UT_TEST_CASE must be executed or not.
         *
         * \param[in] test_case
-        * The name of the test case to be checked.
+        * The entry of the test case to be checked.
         *
         * \returns
         * See the brief description.
@@ -188,11 +385,21 @@ namespace UnitTest {
         * \notes
         * The semantic used is the following:
         *  - When the --tags command line parameter is not given, true is returned (no filtering behaviour).
-        *  - When the given name is not found in the list of enabled UT_TEST_CASEs, false is returned.
-        *  - True is returned only when the UT_TEST_CASE with the given name is found to have a tag from the ones
-        *    specified in the --tags commmand line argument.
+        *  - True is returned only when the tags of the UT_TEST_CASE satisfy the expression given
+        *    to the --tags commmand line argument (see Filter).
         **/
-        static bool has_tag(std::string test_case);
+        static bool has_tag(const CaseEntry &test_case);
+
+        /*!
+         * \brief
+         * It selects, from the static tables, the UT_TEST_CASEs to be executed by the current run
+         * according to the --tags, --filter and sharding command line arguments. No UT_TEST_SUITE code is
+         * executed.
+         *
+         * \returns
+         * void.
+         */
+        static void prepare();
 
         /*!
          * \brief
@@ -225,15 +432,28 @@ namespace UnitTest {
 
         /*!
          * \brief
-         * It sets the name of the UT_TEST_CASE currently executing.
+         * It sets the context of the UT_TEST_CASE currently executing on the calling thread.
          *
-         * \param[in] name
-         * The name of the current UT_TEST_CASE
+         * \param[in] context
+         * The context of the current UT_TEST_CASE (nullptr when no UT_TEST_CASE is executing).
+         *
+         * \returns
+         * void.
+         **/
+        static void set_current_case(CaseContext *context);
+
+        /*!
+         * \brief
+         * It adds a note (e.g. the summary of a Histogram) to be written in the footer of the
+         * current UT_TEST_SUITE.
+         *
+         * \param[in] note
+         * The note, a single line.
          *
          * \returns
          * void.
          **/
-        static void set_current_case(const char *name);
+        static void add_note(const std::string &note);
 
         /*!
          * \brief
@@ -312,11 +532,10 @@ namespace UnitTest {
 
         /*!
          * \brief
-         * It executes all enabled UT_TEST_CASEs of the UT_TEST_SUITE whoose name is given as
-         * value of the function variable.
+         * It executes all enabled UT_TEST_CASEs of the given UT_TEST_SUITE.
          *
-         * \param[in] function
-         * The name of the UT_TEST_SUITE.
+         * \param[in] suite
+         * The entry of the UT_TEST_SUITE.
          *
          * \param[in] file
          * The full path of the file in which the UT_TEST_SUITE has been defined.
@@ -325,26 +544,34 @@ namespace UnitTest {
          * The line in which the UT_TEST_SUITE has been defined.
          *
          * \param[in] cases
-         * The vector with lambda defining UT_TEST_CASEs of the UT_TEST_SUITE.
+         * The array of UT_TEST_CASEs of the UT_TEST_SUITE, in the order they have been enabled.
          *
-         * \param[in] names
-         * The vector with the names of each UT_TEST_CASe in the UT_TEST_SUITE.
+         * \param[in] count
+         * The number of UT_TEST_CASEs in the array.
          *
          * \returns
          * Void.
          **/
         static void run_cases(
-           const char *function,
+           const SuiteEntry &suite,
            const char *file,
            long line,
-           std::function<void()> *cases,
-           std::vector<std::string> &name
+           TestCase *cases,
+           size_t count
         );
 
         /*!
          * \brief
-         * It executes all enabled UT_TEST_CASEs of all required UT_TEST_SUITEs. When --suites and/or
-         * --tags command line arguments are given, filtering behaviour is performed.
+         * It executes all enabled UT_TEST_CASEs of all required UT_TEST_SUITEs. When --suites, --tags
+         * and/or --filter command line arguments are given, filtering behaviour is performed. When the
+         * --threads command line argument is given, the UT_TEST_CASEs of each UT_TEST_SUITE are
+         * executed concurrently by the given number of worker threads. When the --jobs command line
+         * argument is given, the UT_TEST_SUITEs are executed by the given number of worker processes.
+         * When the --durations command line argument is given, the measured durations are stored in
+         * the given file and concurrent executions start the longest UT_TEST_SUITEs/UT_TEST_CASEs first.
+         * When the --shard-count and --shard-index command line arguments are given, only the
+         * UT_TEST_CASEs of the given shard are executed. When the --list command line argument is
+         * given, UT_TEST_SUITEs, UT_TEST_CASEs and tags are listed without executing them.
          *
          * \param[in] argc
          * The number of  command line arguments (it should be the argc argument given to the main).
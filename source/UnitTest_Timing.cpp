@@ -0,0 +1,186 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+
+#include "UnitTest_Timing.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Statistics.hpp"
+#include "UnitTest_TestManager.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define UT_HAS_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define UT_HAS_TSC 1
+#endif
+
+unsigned UnitTest::Timing::m_samples = 15;
+
+namespace {
+
+   // The largest number of batches timed by a throughput measurement
+   const size_t MAX_RATES = 1000;
+}
+
+double UnitTest::Timing::tsc_frequency() {
+#if defined(UT_HAS_TSC)
+   // It is calibrated once against the steady clock (thread-safe static initialization)
+   static const double frequency = []() -> double {
+      auto start = std::chrono::steady_clock::now();
+      unsigned long long ticks = __rdtsc();
+      while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20));
+      ticks = __rdtsc() - ticks;
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return ticks / elapsed;
+   }();
+   return frequency;
+#else
+   return 0.0;
+#endif
+}
+
+double UnitTest::Timing::now(Clock clock) {
+
+   switch (clock) {
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+      case ProcessCpu:
+      case ThreadCpu: {
+         struct timespec ts;
+         clock_gettime((clock == ProcessCpu) ? CLOCK_PROCESS_CPUTIME_ID : CLOCK_THREAD_CPUTIME_ID, &ts);
+         return ts.tv_sec + ts.tv_nsec * 1e-9;
+      }
+#else
+      case ProcessCpu:
+      case ThreadCpu:
+         return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+
+#if defined(UT_HAS_TSC)
+      case Tsc:
+         return __rdtsc() / Timing::tsc_frequency();
+#else
+      case Tsc:
+#endif
+
+      case Steady:
+      default:
+         return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+}
+
+const char *UnitTest::Timing::name(Clock clock) {
+   switch (clock) {
+      case ProcessCpu: return "process cpu";
+      case ThreadCpu: return "thread cpu";
+      case Tsc: return "tsc";
+      case Steady:
+      default: return "steady";
+   }
+}
+
+bool UnitTest::Timing::disturbed() {
+   CaseContext *context = UnitTest::TestManager::m_context;
+   if (context == nullptr || !context->concurrent) return false;
+   if (!context->disturbance_noted.exchange(true)) {
+      UnitTest::Allocations::Pause pause;
+      UnitTest::TestManager::add_note(std::string(context->name) +
+                                      ": timed while other test cases run (--threads), its timings are not compared with the baseline");
+   }
+   return true;
+}
+
+std::vector<double> UnitTest::Timing::measure(Clock clock, const std::function<void(void)> &code) {
+
+   Timing::disturbed();
+
+   // The warmup evaluation pays for cold caches and lazy initialization
+   if (Timing::m_samples > 1) code();
+
+   std::vector<double> samples;
+   {
+      UnitTest::Allocations::Pause pause;
+      samples.reserve(Timing::m_samples);
+   }
+   for (unsigned idx = 0; idx < Timing::m_samples; ++idx) {
+      double start = Timing::now(clock);
+      code();
+      samples.push_back(Timing::now(clock) - start);
+   }
+   return samples;
+}
+
+UnitTest::Timing::Throughput UnitTest::Timing::throughput(const std::function<void(void)> &code) {
+
+   Timing::disturbed();
+
+   // The warmup evaluation pays for cold caches and lazy initialization
+   code();
+
+   // The batch grows until it is long enough to be timed precisely
+   unsigned long long batch = 1;
+   for (;;) {
+      double start = Timing::now(Steady);
+      for (unsigned long long idx = 0; idx < batch; ++idx) code();
+      double elapsed = Timing::now(Steady) - start;
+      if (elapsed >= 1e-3 || batch >= (1ull << 40)) break;
+      batch = (elapsed > 1e-5) ? static_cast<unsigned long long>(batch * 1.2e-3 / elapsed) + 1 : batch * 10;
+   }
+
+   std::vector<double> rates;
+   {
+      UnitTest::Allocations::Pause pause;
+      rates.reserve(MAX_RATES);
+   }
+   double error = 1.0, begin = Timing::now(Steady);
+   while (rates.size() < MAX_RATES) {
+      double start = Timing::now(Steady);
+      for (unsigned long long idx = 0; idx < batch; ++idx) code();
+      double elapsed = Timing::now(Steady) - start;
+      rates.push_back(batch / std::max(elapsed, 1e-9));
+
+      if (rates.size() >= 5) {
+         error = UnitTest::Statistics::stddev(rates) / std::sqrt(double(rates.size())) / UnitTest::Statistics::mean(rates);
+         if (error <= 0.01 || Timing::now(Steady) - begin >= 2.0) break;
+      }
+   }
+   return { UnitTest::Statistics::mean(rates), error, rates.size() };
+}
+
+void UnitTest::Timing::set_samples(unsigned samples) {
+   Timing::m_samples = std::max(samples, 1u);
+}
+
+unsigned UnitTest::Timing::samples() {
+   return Timing::m_samples;
+}
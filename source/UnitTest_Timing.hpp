@@ -0,0 +1,170 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <functional>
+#include <vector>
+
+#ifndef _UNIT_TEST_TIMING_HPP_
+#define _UNIT_TEST_TIMING_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It measures code on a chosen clock, re-sampling it so that timing asserts can judge the
+     * median (or another percentile) of the measurements instead of a single one.
+     **/
+    class Timing {
+
+    public:
+
+        /*!
+         * \brief
+         * The clocks code can be measured on.
+         *
+         * \notes
+         *  - Steady: the monotonic wall clock (std::chrono::steady_clock).
+         *  - ProcessCpu: the CPU time of the whole process (CLOCK_PROCESS_CPUTIME_ID).
+         *  - ThreadCpu: the CPU time of the calling thread (CLOCK_THREAD_CPUTIME_ID).
+         *  - Tsc: the time stamp counter of the processor, converted to seconds. It falls back to
+         *    Steady where it is not available.
+         **/
+        enum Clock { Steady, ProcessCpu, ThreadCpu, Tsc };
+
+        /*!
+         * \brief
+         * The rate code is evaluated at, as measured by throughput.
+         **/
+        struct Throughput {
+
+            // The number of evaluations per second (the mean of the samples).
+            double per_second;
+
+            // The relative standard error of per_second.
+            double error;
+
+            // The number of samples taken.
+            size_t samples;
+        };
+
+    private:
+
+        // The number of samples taken by the timing asserts.
+        static unsigned m_samples;
+
+        // It returns the number of ticks of the time stamp counter per second.
+        static double tsc_frequency();
+
+    public:
+
+        /*!
+         * \brief
+         * It reads the given clock.
+         *
+         * \param[in] clock
+         * The clock.
+         *
+         * \returns
+         * The time, in seconds, from an unspecified origin.
+         */
+        static double now(Clock clock);
+
+        /*!
+         * \brief
+         * It returns the name of the given clock.
+         *
+         * \param[in] clock
+         * The clock.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static const char *name(Clock clock);
+
+        /*!
+         * \brief
+         * It measures the given code: after a discarded warmup evaluation it is evaluated as many
+         * times as the number of samples.
+         *
+         * \param[in] clock
+         * The clock to measure the code on.
+         *
+         * \param[in] code
+         * The code to be measured.
+         *
+         * \returns
+         * The duration, in seconds, of each evaluation.
+         */
+        static std::vector<double> measure(Clock clock, const std::function<void(void)> &code);
+
+        /*!
+         * \brief
+         * It measures how many times per second the given code can be evaluated, on the steady
+         * clock. The code is evaluated in batches lasting about a millisecond, and batches are
+         * sampled until the relative standard error of the mean rate falls below 1% (at least 5
+         * and at most 1000 samples, within about two seconds).
+         *
+         * \param[in] code
+         * The code to be measured.
+         *
+         * \returns
+         * The rate of the code.
+         */
+        static Throughput throughput(const std::function<void(void)> &code);
+
+        /*!
+         * \brief
+         * It tells whether the timings of the current UT_TEST_CASE are disturbed by other ones
+         * running at the same time (--threads only runs UT_BENCHMARKs alone). The first time it
+         * is, the footer of the suite tells it: such timings are not compared with the baseline.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool disturbed();
+
+        /*!
+         * \brief
+         * It sets the number of samples taken by the timing asserts.
+         *
+         * \param[in] samples
+         * The number of samples.
+         *
+         * \returns
+         * void.
+         */
+        static void set_samples(unsigned samples);
+
+        /*!
+         * \brief
+         * It returns the number of samples taken by the timing asserts.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static unsigned samples();
+    };
+}
+
+#endif
@@ -0,0 +1,238 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdio>
+#include <mutex>
+
+#include "UnitTest_Trace.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_Utility.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+std::string UnitTest::Trace::m_path;
+double UnitTest::Trace::m_origin = 0.0;
+
+namespace {
+
+   // The number of events each thread makes room for at once
+   const size_t RESERVED_EVENTS = 4096;
+
+   // An event of the trace, names are not copied
+   struct Event {
+      char phase;
+      const char *category;
+      const char *name;
+      const char *suite;
+      std::string detail;
+      double timestamp;
+      double duration;
+   };
+
+   // The events recorded by a thread
+   struct Buffer {
+      int pid;
+      long tid;
+      bool main;
+      std::vector<Event> events;
+   };
+
+   // The buffers of all threads, they outlive their threads so that they are written at the end of the run
+   std::vector<std::unique_ptr<Buffer>> g_buffers;
+   std::mutex g_mutex;
+
+   // The buffer of the calling thread
+   thread_local Buffer *t_buffer = nullptr;
+
+   // The thread that enabled tracing (or that forked the worker process)
+   std::thread::id g_main;
+
+   // The process identifiers of the workers whose part files are merged
+   std::vector<int> g_parts;
+
+   double now() {
+      return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   int process() {
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+      return static_cast<int>(getpid());
+#else
+      return 1;
+#endif
+   }
+
+   Buffer &buffer() {
+      if (t_buffer != nullptr) return *t_buffer;
+
+      // The buffer lives as long as the run, it is not charged to the UT_TEST_CASE creating it
+      UnitTest::Allocations::Pause pause;
+      std::unique_ptr<Buffer> buffer(new Buffer());
+      buffer->pid = process();
+      buffer->main = std::this_thread::get_id() == g_main;
+      buffer->events.reserve(RESERVED_EVENTS);
+      std::lock_guard<std::mutex> lock(g_mutex);
+#if defined(__linux__)
+      buffer->tid = static_cast<long>(syscall(SYS_gettid));
+#else
+      buffer->tid = static_cast<long>(g_buffers.size() + 1);
+#endif
+      t_buffer = buffer.get();
+      g_buffers.push_back(std::move(buffer));
+      return *t_buffer;
+   }
+
+   void record(char phase, const char *category, const char *name, const char *suite, std::string detail,
+               double timestamp, double duration) {
+      UnitTest::Allocations::Pause pause;
+      Event event = { phase, category, name, suite, std::move(detail), timestamp, duration };
+      buffer().events.push_back(std::move(event));
+   }
+
+   // It writes the events of this process, one per line
+   void write_events(std::ostream &out, bool &first) {
+      std::lock_guard<std::mutex> lock(g_mutex);
+      out << std::fixed << std::setprecision(3);
+      for (auto buffer = std::begin(g_buffers); buffer != std::end(g_buffers); ++buffer) {
+         const Buffer &current = **buffer;
+         out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << current.pid << ",\"tid\":" << current.tid
+             << ",\"args\":{\"name\":" << UnitTest::Utility::quote(current.main ? "main" : "thread " + std::to_string(current.tid)) << "}}";
+         first = false;
+         for (auto it = std::begin(current.events); it != std::end(current.events); ++it) {
+            out << ",\n{\"name\":" << UnitTest::Utility::quote(it->name) << ",\"cat\":\"" << it->category << "\",\"ph\":\"" << it->phase
+                << "\",\"ts\":" << it->timestamp << ",\"pid\":" << current.pid << ",\"tid\":" << current.tid;
+            if (it->phase == 'X') out << ",\"dur\":" << it->duration;
+            if (it->phase == 'i') out << ",\"s\":\"t\"";
+            if (it->suite != nullptr || !it->detail.empty()) {
+               out << ",\"args\":{";
+               if (it->suite != nullptr) out << "\"suite\":" << UnitTest::Utility::quote(it->suite) << (it->detail.empty() ? "" : ",");
+               if (!it->detail.empty()) out << "\"detail\":" << UnitTest::Utility::quote(it->detail);
+               out << "}";
+            }
+            out << "}";
+         }
+      }
+   }
+
+   std::string part_path(const std::string &path, int pid) {
+      return path + "." + std::to_string(pid) + ".part";
+   }
+}
+
+UnitTest::Trace::Span::Span(const char *category, const char *name, const char *suite) :
+   m_category(Trace::enabled() ? category : nullptr),
+   m_name(name),
+   m_suite(suite),
+   m_start(0.0) {
+
+   // The buffer of the thread is made before the span starts, so that it is not charged to it
+   if (m_category == nullptr) return;
+   buffer();
+   m_start = now() - Trace::m_origin;
+}
+
+UnitTest::Trace::Span::~Span() {
+   if (m_category == nullptr) return;
+   double end = now() - Trace::m_origin;
+   record('X', m_category, m_name, m_suite, std::string(), m_start, end - m_start);
+}
+
+void UnitTest::Trace::set_output(const std::string &path) {
+   Trace::m_path = path;
+   Trace::m_origin = now();
+   g_main = std::this_thread::get_id();
+}
+
+bool UnitTest::Trace::enabled() {
+   return !Trace::m_path.empty();
+}
+
+void UnitTest::Trace::instant(const char *category, const char *name, std::string detail) {
+   if (!Trace::enabled()) return;
+   record('i', category, name, nullptr, std::move(detail), now() - Trace::m_origin, 0.0);
+}
+
+void UnitTest::Trace::forked() {
+   std::lock_guard<std::mutex> lock(g_mutex);
+   g_buffers.clear();
+   g_parts.clear();
+   t_buffer = nullptr;
+   g_main = std::this_thread::get_id();
+}
+
+bool UnitTest::Trace::save_part() {
+   if (!Trace::enabled()) return true;
+   std::ofstream out(part_path(Trace::m_path, process()).c_str(), std::ios::out | std::ios::trunc);
+   bool first = true;
+   write_events(out, first);
+   return static_cast<bool>(out);
+}
+
+void UnitTest::Trace::add_part(int pid) {
+   if (!Trace::enabled()) return;
+   std::lock_guard<std::mutex> lock(g_mutex);
+   g_parts.push_back(pid);
+}
+
+bool UnitTest::Trace::save() {
+
+   if (!Trace::enabled()) return true;
+
+   std::ofstream out(Trace::m_path.c_str(), std::ios::out | std::ios::trunc);
+   if (!out) return false;
+
+   out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+   bool first = true;
+   out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << process() << ",\"args\":{\"name\":\"runner\"}}";
+   first = false;
+   write_events(out, first);
+
+   // Worker processes wrote their events to part files, named after them
+   for (auto it = std::begin(g_parts); it != std::end(g_parts); ++it) {
+      std::string path = part_path(Trace::m_path, *it);
+      std::ifstream part(path.c_str());
+      if (!part) continue;
+      out << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << *it << ",\"args\":{\"name\":\"worker " << *it << "\"}}";
+      std::string line;
+      for (bool head = true; std::getline(part, line); head = false) out << (head ? ",\n" : "\n") << line;
+      part.close();
+      std::remove(path.c_str());
+   }
+
+   out << "\n]}\n";
+   return static_cast<bool>(out);
+}
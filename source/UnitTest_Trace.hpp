@@ -0,0 +1,176 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <string>
+
+#ifndef _UNIT_TEST_TRACE_HPP_
+#define _UNIT_TEST_TRACE_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It records a timeline of the run in the trace event format read by chrome://tracing and
+     * Perfetto: a span for each UT_TEST_SUITE, UT_TEST_CASE_INIT, UT_TEST_CASE body and
+     * UT_TEST_CASE_CLEANUP, an instant event for each failed Assert or Require, each event tagged
+     * with its process and thread. Events are appended to a buffer of the recording thread, without
+     * locks, and written once the run is over; worker processes (see --jobs) write their events to
+     * part files that the parent process merges.
+     **/
+    class Trace {
+
+    private:
+
+        // The path of the trace file (empty when tracing is disabled).
+        static std::string m_path;
+
+        // The start of the run, timestamps are relative to it.
+        static double m_origin;
+
+    public:
+
+        /*!
+         * \brief
+         * It records the span of its lifetime on the calling thread.
+         **/
+        class Span {
+
+        private:
+
+            // The category of the span (suite, init, case or cleanup), nullptr when tracing is disabled.
+            const char *m_category;
+
+            // The name of the span.
+            const char *m_name;
+
+            // The UT_TEST_SUITE the span belongs to (nullptr for none).
+            const char *m_suite;
+
+            // The start of the span, in microseconds.
+            double m_start;
+
+        public:
+
+            /*!
+             * \brief
+             * It starts the span. Names are not copied, they must outlive the run (e.g. the names
+             * of UT_TEST_SUITEs and UT_TEST_CASEs).
+             *
+             * \param[in] category
+             * The category of the span.
+             *
+             * \param[in] name
+             * The name of the span.
+             *
+             * \param[in] suite
+             * The UT_TEST_SUITE the span belongs to (nullptr for none).
+             */
+            Span(const char *category, const char *name, const char *suite = nullptr);
+
+            ~Span();
+
+            Span(const Span &) = delete;
+            Span &operator=(const Span &) = delete;
+        };
+
+        /*!
+         * \brief
+         * It enables tracing, the trace will be written to the given file.
+         *
+         * \param[in] path
+         * The path of the trace file.
+         *
+         * \returns
+         * void.
+         */
+        static void set_output(const std::string &path);
+
+        /*!
+         * \brief
+         * It tells whether the run is traced.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool enabled();
+
+        /*!
+         * \brief
+         * It records an instant event on the calling thread.
+         *
+         * \param[in] category
+         * The category of the event.
+         *
+         * \param[in] name
+         * The name of the event, it must outlive the run.
+         *
+         * \param[in] detail
+         * The description of the event.
+         *
+         * \returns
+         * void.
+         */
+        static void instant(const char *category, const char *name, std::string detail);
+
+        /*!
+         * \brief
+         * It discards the events of the parent process in a forked worker process.
+         *
+         * \returns
+         * void.
+         */
+        static void forked();
+
+        /*!
+         * \brief
+         * It writes the events of a worker process to its part file.
+         *
+         * \returns
+         * True on success.
+         */
+        static bool save_part();
+
+        /*!
+         * \brief
+         * It makes the parent process merge the part file of a worker process.
+         *
+         * \param[in] pid
+         * The process identifier of the worker.
+         *
+         * \returns
+         * void.
+         */
+        static void add_part(int pid);
+
+        /*!
+         * \brief
+         * It writes the trace file with the events of this process and of its workers.
+         *
+         * \returns
+         * True on success (or when tracing is disabled).
+         */
+        static bool save();
+    };
+}
+
+#endif // _UNIT_TEST_TRACE_HPP_
@@ -0,0 +1,193 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <deque>
+
+#include "UnitTest_Typed.hpp"
+#include "UnitTest_Allocations.hpp"
+#include "UnitTest_TestManager.hpp"
+#include "UnitTest_Utility.hpp"
+
+namespace {
+
+   // It holds the names and tags of the instances, they must outlive the entries referring to them
+   std::deque<std::string> &strings() {
+      static std::deque<std::string> strings;
+      return strings;
+   }
+
+   // It removes the spaces around the given string
+   std::string trim(const std::string &value) {
+      size_t first = value.find_first_not_of(" \t\r\n");
+      if (first == std::string::npos) return "";
+      return value.substr(first, value.find_last_not_of(" \t\r\n") - first + 1);
+   }
+
+   // It turns the name of a type into a tag (tags cannot contain spaces, commas or parentheses)
+   std::string to_tag(const std::string &type) {
+      std::string tag;
+      for (auto it = std::begin(type); it != std::end(type); ++it) {
+         if (*it == ' ') continue;
+         tag += (*it == ',') ? ';' : (*it == '(') ? '[' : (*it == ')') ? ']' : *it;
+      }
+      return tag;
+   }
+}
+
+// Static member initialization
+UnitTest::TypedLinker *UnitTest::TypedLinker::m_pending = nullptr;
+
+UnitTest::TypedLinker::TypedLinker(
+   CaseEntry *entries, const CaseEntry &prototype, const char *types, size_t type_count, const size_t *sizes, size_t size_count) :
+   m_entries(entries),
+   m_types(types),
+   m_type_count(type_count),
+   m_sizes(sizes),
+   m_size_count(size_count),
+   m_next(TypedLinker::m_pending) {
+
+   TypedLinker::m_pending = this;
+   for (size_t index = 0; index < type_count * size_count; ++index) {
+      entries[index] = prototype;
+      UnitTest::Registry::link(entries[index]);
+   }
+}
+
+void UnitTest::TypedLinker::name_instances() {
+
+   for (TypedLinker *linker = TypedLinker::m_pending; linker != nullptr; linker = linker->m_next) {
+      std::vector<std::string> names = UnitTest::TypedMatrix::split_types(linker->m_types);
+      for (size_t type = 0; type < linker->m_type_count; ++type) {
+         for (size_t idx = 0; idx < linker->m_size_count; ++idx) {
+            CaseEntry &entry = linker->m_entries[type * linker->m_size_count + idx];
+            std::string name = (type < names.size()) ? names[type] : std::to_string(type);
+            std::string size = std::to_string(linker->m_sizes[idx]);
+            strings().push_back(std::string(entry.name) + "<" + name + "," + size + ">");
+            entry.name = strings().back().c_str();
+            strings().push_back(std::string(entry.tags) + "," + to_tag(name) + ",size=" + size);
+            entry.tags = strings().back().c_str();
+         }
+      }
+   }
+   TypedLinker::m_pending = nullptr;
+}
+
+UnitTest::TypedMatrix::TypedMatrix(const char *name, const char *types, const size_t *sizes, size_t count, bool benchmark) :
+   m_name(name),
+   m_types(TypedMatrix::split_types(types)),
+   m_sizes(sizes, sizes + count),
+   m_cells(m_types.size() * count),
+   m_benchmark(benchmark) {
+}
+
+UnitTest::TypedMatrix::~TypedMatrix() {
+
+   if (std::all_of(m_cells.begin(), m_cells.end(), [](const std::string &cell) { return cell.empty(); })) return;
+
+   size_t width = 4;
+   for (auto it = std::begin(m_types); it != std::end(m_types); ++it) width = std::max(width, it->size());
+
+   // Each column is as wide as its widest cell, its header included, so that all rows line up
+   std::vector<size_t> columns(m_sizes.size());
+   for (size_t size = 0; size < m_sizes.size(); ++size) {
+      columns[size] = std::to_string(m_sizes[size]).size();
+      for (size_t type = 0; type < m_types.size(); ++type)
+         columns[size] = std::max(columns[size], std::max<size_t>(1, m_cells[type * m_sizes.size() + size].size()));
+      columns[size] += 2;
+   }
+
+   UnitTest::TestManager::add_note(m_name + (m_benchmark ? " (median time per iteration)" : " (outcome and duration)"));
+   std::stringstream ss;
+   ss << std::left << std::setw(static_cast<int>(width)) << "" << std::right;
+   for (size_t size = 0; size < m_sizes.size(); ++size) ss << std::setw(static_cast<int>(columns[size])) << m_sizes[size];
+   UnitTest::TestManager::add_note(ss.str());
+
+   for (size_t type = 0; type < m_types.size(); ++type) {
+      ss.str("");
+      ss << std::left << std::setw(static_cast<int>(width)) << m_types[type] << std::right;
+      for (size_t size = 0; size < m_sizes.size(); ++size) {
+         const std::string &cell = m_cells[type * m_sizes.size() + size];
+         ss << std::setw(static_cast<int>(columns[size])) << (cell.empty() ? "-" : cell);
+      }
+      UnitTest::TestManager::add_note(ss.str());
+   }
+}
+
+std::vector<std::string> UnitTest::TypedMatrix::split_types(const char *types) {
+
+   // Commas nested in template arguments or parentheses do not separate types
+   std::string list = types;
+   size_t first = list.find('('), last = list.rfind(')');
+   if (first != std::string::npos && last != std::string::npos && last > first) list = list.substr(first + 1, last - first - 1);
+
+   std::vector<std::string> names;
+   std::string current;
+   int depth = 0;
+   for (auto it = std::begin(list); it != std::end(list); ++it) {
+      if (*it == '<' || *it == '(' || *it == '[') ++depth;
+      if (*it == '>' || *it == ')' || *it == ']') --depth;
+      if (*it == ',' && depth == 0) {
+         names.push_back(trim(current));
+         current.clear();
+         continue;
+      }
+      current += *it;
+   }
+   names.push_back(trim(current));
+   return names;
+}
+
+void UnitTest::TypedMatrix::run_test(size_t index, const std::function<void(void)> &body) {
+
+   auto start = std::chrono::steady_clock::now();
+   auto outcome = [&]() -> std::string {
+      CaseContext *context = UnitTest::TestManager::m_context;
+      double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      return std::string((context != nullptr && context->failures > 0) ? "KO " : "OK ") + UnitTest::Utility::format_time(elapsed);
+   };
+
+   try { body(); }
+   catch (...) {
+      UnitTest::Allocations::Pause pause;
+      m_cells[index] = outcome();
+      m_cells[index].replace(0, 2, "KO");
+      throw;
+   }
+   UnitTest::Allocations::Pause pause;
+   m_cells[index] = outcome();
+}
+
+void UnitTest::TypedMatrix::run_benchmark(size_t index, Benchmark &benchmark) {
+   size_t measured = UnitTest::Benchmark::results().size();
+   benchmark();
+   UnitTest::Allocations::Pause pause;
+   if (UnitTest::Benchmark::results().size() > measured)
+      m_cells[index] = UnitTest::Utility::format_time(UnitTest::Benchmark::results().back().median);
+   else
+      m_cells[index] = "KO";
+}
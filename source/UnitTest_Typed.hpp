@@ -0,0 +1,298 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <functional>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include "UnitTest_Registry.hpp"
+#include "UnitTest_Benchmark.hpp"
+
+#ifndef _UNIT_TEST_TYPED_HPP_
+#define _UNIT_TEST_TYPED_HPP_
+
+// It removes the parentheses around a list given as a single macro argument
+#define UT_UNPAREN(...) __VA_ARGS__
+
+// UT_TYPED_TEST_CASE declaration where:
+//		CASE is the name to assign to the UT_TYPED_TEST_CASE
+//		BODY is a class template (declared at namespace scope) whose instances BODY<TYPE> have a
+//		     void operator()(size_t size) executing the test on TYPE and size
+//		TYPES is the parenthesized list of types, e.g. (std::vector<int>, std::deque<int>)
+//		SIZES is the parenthesized list of sizes, e.g. (16, 1024, 65536)
+//		__VA_ARGS__ is the list of words to use to tag the UT_TYPED_TEST_CASE
+// 	NOTE: When __VA_ARGS__ is empty the comma after SIZES is mandatory
+//	An instance named CASE<TYPE,SIZE> is registered at compile time for each type and size, it
+//	is tagged with the tags of the UT_TYPED_TEST_CASE, with TYPE and with size=SIZE. Enabling
+//	CASE enables all instances; their outcome is written as a matrix in the footer of the suite.
+#define UT_TYPED_TEST_CASE(CASE, BODY, TYPES, SIZES, ...) \
+   struct CASE##_ut_case { \
+      static constexpr const char *name() { return #CASE; } \
+      static constexpr const char *tags() { return #__VA_ARGS__; } \
+      static constexpr const char *types() { return #TYPES; } \
+      static constexpr long line() { return __LINE__; } \
+      static constexpr bool exclusive() { return false; } \
+   }; \
+   UnitTest::TestCase CASE = UnitTest::TypedRegistrar<ut_suite_t, CASE##_ut_case, \
+      UnitTest::Types<UT_UNPAREN TYPES>, UnitTest::Sizes<UT_UNPAREN SIZES>>::template instances<BODY>()
+
+// UT_TYPED_BENCHMARK declaration: like UT_TYPED_TEST_CASE, but the instances are UT_BENCHMARKs
+// and BODY<TYPE> has a void operator()(UnitTest::BenchmarkState &state, size_t size) looping while
+// state.KeepRunning() returns true. The matrix holds the median time of each instance.
+#define UT_TYPED_BENCHMARK(CASE, BODY, TYPES, SIZES, ...) \
+   struct CASE##_ut_case { \
+      static constexpr const char *name() { return #CASE; } \
+      static constexpr const char *tags() { return #__VA_ARGS__; } \
+      static constexpr const char *types() { return #TYPES; } \
+      static constexpr long line() { return __LINE__; } \
+      static constexpr bool exclusive() { return true; } \
+   }; \
+   UnitTest::TestCase CASE = UnitTest::TypedRegistrar<ut_suite_t, CASE##_ut_case, \
+      UnitTest::Types<UT_UNPAREN TYPES>, UnitTest::Sizes<UT_UNPAREN SIZES>>::template instances<BODY>()
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * The list of types of a UT_TYPED_TEST_CASE.
+     **/
+    template<typename... TYPES>
+    struct Types {
+        static const size_t count = sizeof...(TYPES);
+    };
+
+    /*!
+     * \brief
+     * The list of sizes of a UT_TYPED_TEST_CASE.
+     **/
+    template<size_t... SIZES>
+    struct Sizes {
+        static const size_t count = sizeof...(SIZES);
+
+        static const size_t *values() {
+           static const size_t values[] = { SIZES... };
+           return values;
+        }
+    };
+
+    /*!
+     * \brief
+     * It links the instances of a typed UT_TEST_CASE during static initialization, without
+     * allocating memory: they are named and tagged after their type and size by Registry::finalize
+     * (see name_instances), until then they bear the name and tags of the typed UT_TEST_CASE.
+     **/
+    class TypedLinker {
+
+    private:
+
+        // The first linker whose instances have not been named yet.
+        static TypedLinker *m_pending;
+
+        // The entries of the instances, types major.
+        CaseEntry *m_entries;
+
+        // The parenthesized list of types, as written in the UT_TYPED_TEST_CASE.
+        const char *m_types;
+
+        // The number of types.
+        size_t m_type_count;
+
+        // The sizes.
+        const size_t *m_sizes;
+
+        // The number of sizes.
+        size_t m_size_count;
+
+        // The next linker whose instances have not been named yet.
+        TypedLinker *m_next;
+
+    public:
+
+        TypedLinker(CaseEntry *entries, const CaseEntry &prototype, const char *types, size_t type_count,
+                    const size_t *sizes, size_t size_count);
+
+        /*!
+         * \brief
+         * It names and tags the instances of every typed UT_TEST_CASE after their type and size
+         * (CASE<TYPE,SIZE>). It is called by Registry::finalize, once static initialization is over.
+         *
+         * \returns
+         * void.
+         */
+        static void name_instances();
+    };
+
+    /*!
+     * \brief
+     * It collects the outcome of the instances of a typed UT_TEST_CASE and, once they are over,
+     * it writes them in the footer of the UT_TEST_SUITE as a matrix of types by sizes.
+     **/
+    class TypedMatrix {
+
+    private:
+
+        // The name of the typed UT_TEST_CASE.
+        std::string m_name;
+
+        // The names of the types.
+        std::vector<std::string> m_types;
+
+        // The sizes.
+        std::vector<size_t> m_sizes;
+
+        // The outcome of each instance, types by sizes (empty when it has not been executed).
+        std::vector<std::string> m_cells;
+
+        // It holds whether the instances are UT_BENCHMARKs.
+        bool m_benchmark;
+
+    public:
+
+        TypedMatrix(const char *name, const char *types, const size_t *sizes, size_t count, bool benchmark);
+
+        ~TypedMatrix();
+
+        /*!
+         * \brief
+         * It splits the parenthesized list of types of a typed UT_TEST_CASE.
+         *
+         * \param[in] types
+         * The list of types, as written in the UT_TYPED_TEST_CASE.
+         *
+         * \returns
+         * The names of the types.
+         */
+        static std::vector<std::string> split_types(const char *types);
+
+        /*!
+         * \brief
+         * It executes the body of an instance and records its outcome.
+         *
+         * \param[in] index
+         * The index of the instance.
+         *
+         * \param[in] body
+         * The body of the instance.
+         *
+         * \returns
+         * void.
+         */
+        void run_test(size_t index, const std::function<void(void)> &body);
+
+        /*!
+         * \brief
+         * It measures an instance that is a UT_BENCHMARK and records its median time.
+         *
+         * \param[in] index
+         * The index of the instance.
+         *
+         * \param[in] benchmark
+         * The UT_BENCHMARK of the instance.
+         *
+         * \returns
+         * void.
+         */
+        void run_benchmark(size_t index, Benchmark &benchmark);
+    };
+
+    /*!
+     * \brief
+     * It holds the entries of the instances of the typed UT_TEST_CASE described by CASE in the
+     * UT_TEST_SUITE described by SUITE, one for each type of TYPES and size of SIZES (types major).
+     **/
+    template<typename SUITE, typename CASE, typename TYPES, typename SIZES>
+    struct TypedRegistrar {
+
+        static_assert(TYPES::count > 0 && SIZES::count > 0, "A typed UT_TEST_CASE needs at least a type and a size");
+
+        static CaseEntry entries[TYPES::count * SIZES::count];
+        static TypedLinker linker;
+
+        /*!
+         * \brief
+         * It binds the instances of BODY to their entries.
+         *
+         * \returns
+         * A TestCase standing for all the instances.
+         */
+        template<template<typename> class BODY>
+        static TestCase instances() {
+           (void) &linker;
+           std::shared_ptr<TypedMatrix> matrix = std::make_shared<TypedMatrix>(
+              CASE::name(), CASE::types(), SIZES::values(), SIZES::count, CASE::exclusive());
+           std::vector<TestCase> cases;
+           add<BODY>(cases, matrix, TYPES());
+           return TestCase(cases);
+        }
+
+    private:
+
+        template<template<typename> class BODY, typename... T>
+        static void add(std::vector<TestCase> &cases, const std::shared_ptr<TypedMatrix> &matrix, Types<T...>) {
+           int expand[] = { (add_type<BODY, T>(cases, matrix), 0)... };
+           (void) expand;
+        }
+
+        template<template<typename> class BODY, typename T>
+        static void add_type(std::vector<TestCase> &cases, const std::shared_ptr<TypedMatrix> &matrix) {
+           for (size_t idx = 0; idx < SIZES::count; ++idx) {
+              size_t index = cases.size();
+              cases.push_back(instance<BODY<T>>(entries[index], matrix, index, SIZES::values()[idx],
+                                                std::integral_constant<bool, CASE::exclusive()>()));
+           }
+        }
+
+        template<typename INSTANCE>
+        static TestCase instance(const CaseEntry &entry, const std::shared_ptr<TypedMatrix> &matrix, size_t index,
+                                 size_t size, std::false_type) {
+           return TestCase(entry) = [matrix, index, size]() -> void {
+              matrix->run_test(index, [size]() -> void { INSTANCE()(size); });
+           };
+        }
+
+        template<typename INSTANCE>
+        static TestCase instance(const CaseEntry &entry, const std::shared_ptr<TypedMatrix> &matrix, size_t index,
+                                 size_t size, std::true_type) {
+           Benchmark benchmark(entry);
+           benchmark = [size](BenchmarkState &state) -> void { INSTANCE()(state, size); };
+           return TestCase(entry) = [matrix, index, benchmark]() mutable -> void {
+              matrix->run_benchmark(index, benchmark);
+           };
+        }
+    };
+
+    template<typename SUITE, typename CASE, typename TYPES, typename SIZES>
+    CaseEntry TypedRegistrar<SUITE, CASE, TYPES, SIZES>::entries[TYPES::count * SIZES::count];
+
+    template<typename SUITE, typename CASE, typename TYPES, typename SIZES>
+    TypedLinker TypedRegistrar<SUITE, CASE, TYPES, SIZES>::linker(
+       TypedRegistrar<SUITE, CASE, TYPES, SIZES>::entries,
+       CaseEntry{ CASE::name(), CASE::tags(), CASE::line(), CASE::exclusive(), &SuiteRegistrar<SUITE>::entry, nullptr, -1, false, 0 },
+       CASE::types(), TYPES::count, SIZES::values(), SIZES::count);
+}
+
+#endif
@@ -1,5 +1,14 @@
+#include <cstring>
+#include <cstdlib>
+
 #include "UnitTest_Utility.hpp"
 
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#define UT_HAS_DLADDR 1
+#endif
+
 void UnitTest::Utility::split(std::string s, char delimiter, std::vector<std::string> &v, bool strip_spaces) {
    std::stringstream ss(s);
    std::string item;
@@ -50,3 +59,76 @@ std::string UnitTest::Utility::formatfinfo(const char *filename, long line, cons
       << fname.substr(fname.length() - half_inner_length + 1, static_cast<size_t>(half_inner_length)) << ": " << line;
    return ss.str();
 }
+
+uint64_t UnitTest::Utility::hash(const char *data) {
+   uint64_t value = 14695981039346656037ULL;
+   for (const unsigned char *it = reinterpret_cast<const unsigned char *>(data); *it != 0; ++it) {
+      value ^= *it;
+      value *= 1099511628211ULL;
+   }
+   return value;
+}
+
+std::string UnitTest::Utility::format_time(double nanoseconds) {
+   std::stringstream ss;
+   ss << std::fixed << std::setprecision(2);
+   if (nanoseconds < 1e3) ss << nanoseconds << " ns";
+   else if (nanoseconds < 1e6) ss << nanoseconds / 1e3 << " us";
+   else if (nanoseconds < 1e9) ss << nanoseconds / 1e6 << " ms";
+   else ss << nanoseconds / 1e9 << " s";
+   return ss.str();
+}
+
+std::string UnitTest::Utility::format_bytes(double bytes) {
+   std::stringstream ss;
+   ss << std::fixed << std::setprecision(2);
+   if (bytes < 1024.0) ss << std::setprecision(0) << bytes << " B";
+   else if (bytes < 1024.0 * 1024.0) ss << bytes / 1024.0 << " KiB";
+   else if (bytes < 1024.0 * 1024.0 * 1024.0) ss << bytes / (1024.0 * 1024.0) << " MiB";
+   else ss << bytes / (1024.0 * 1024.0 * 1024.0) << " GiB";
+   return ss.str();
+}
+
+std::string UnitTest::Utility::symbolize(const void *frame, bool offset) {
+   std::stringstream ss;
+#if defined(UT_HAS_DLADDR)
+   Dl_info info;
+   if (dladdr(frame, &info) != 0 && info.dli_sname != nullptr) {
+      int status = 0;
+      char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      ss << ((status == 0 && demangled != nullptr) ? demangled : info.dli_sname);
+      if (offset) ss << "+0x" << std::hex << (static_cast<const char *>(frame) - static_cast<const char *>(info.dli_saddr));
+      std::free(demangled);
+      return ss.str();
+   }
+   if (dladdr(frame, &info) != 0 && info.dli_fname != nullptr) {
+      const char *module = std::strrchr(info.dli_fname, '/');
+      ss << (module != nullptr ? module + 1 : info.dli_fname) << "+0x" << std::hex << (static_cast<const char *>(frame) - static_cast<const char *>(info.dli_fbase));
+      return ss.str();
+   }
+#endif
+   ss << frame;
+   return ss.str();
+}
+
+std::string UnitTest::Utility::quote(const std::string &value) {
+   std::stringstream ss;
+   ss << '"';
+   for (auto it = std::begin(value); it != std::end(value); ++it) {
+      if (*it == '"' || *it == '\\') ss << '\\' << *it;
+      else if (static_cast<unsigned char>(*it) < 0x20) ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(*it) << std::dec;
+      else ss << *it;
+   }
+   ss << '"';
+   return ss.str();
+}
+
+std::string UnitTest::Utility::format_count(double count) {
+   std::stringstream ss;
+   ss << std::fixed << std::setprecision(2);
+   if (count < 1e3) ss << count;
+   else if (count < 1e6) ss << count / 1e3 << " K";
+   else if (count < 1e9) ss << count / 1e6 << " M";
+   else ss << count / 1e9 << " G";
+   return ss.str();
+}
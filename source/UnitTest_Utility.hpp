@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <cstdint>
 
 
 #ifndef _UNIT_TEST_UTILITY_HPP_
@@ -100,6 +101,85 @@ namespace UnitTest {
          * The centered string.
          **/
         static std::string center(const char *data, size_t length);
+
+        /*!
+         * \brief
+         * It computes the 64 bits FNV-1a hash of the given string. The result does not depend on
+         * the platform nor on the run, so it can be used to take decisions that must be the same
+         * across different processes and machines.
+         *
+         * \param[in] data
+         * The string to be hashed.
+         *
+         * \return
+         * The hash of the given string.
+         **/
+        static uint64_t hash(const char *data);
+
+        /*!
+         * \brief
+         * It formats a time span with the most readable unit (ns, us, ms or s).
+         *
+         * \param[in] nanoseconds
+         * The time span, in nanoseconds.
+         *
+         * \return
+         * The formatted time span.
+         **/
+        static std::string format_time(double nanoseconds);
+
+        /*!
+         * \brief
+         * It formats an amount of memory with the most readable unit (B, KiB, MiB or GiB).
+         *
+         * \param[in] bytes
+         * The amount of memory, in bytes.
+         *
+         * \return
+         * The formatted amount of memory.
+         **/
+        static std::string format_bytes(double bytes);
+
+        /*!
+         * \brief
+         * It formats a count with the most readable decimal suffix (none, K, M or G).
+         *
+         * \param[in] count
+         * The count.
+         *
+         * \return
+         * The formatted count.
+         **/
+        static std::string format_count(double count);
+
+        /*!
+         * \brief
+         * It describes a frame of a call stack: the demangled name of its function, or the name
+         * of its module and the offset of the frame in it when the function has no dynamic
+         * symbol (see -rdynamic).
+         *
+         * \param[in] frame
+         * The return address of the frame.
+         *
+         * \param[in] offset
+         * True to append the offset of the frame in its function.
+         *
+         * \return
+         * The description of the frame.
+         **/
+        static std::string symbolize(const void *frame, bool offset = true);
+
+        /*!
+         * \brief
+         * It writes a string as a JSON string (quoted and escaped).
+         *
+         * \param[in] value
+         * The string.
+         *
+         * \return
+         * The JSON string.
+         **/
+        static std::string quote(const std::string &value);
     };
 
 }
@@ -0,0 +1,441 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <new>
+
+#include "UnitTest_Workers.hpp"
+#include "UnitTest_TestManager.hpp"
+#include "UnitTest_Console.hpp"
+#include "UnitTest_Durations.hpp"
+#include "UnitTest_Registry.hpp"
+#include "UnitTest_Baseline.hpp"
+#include "UnitTest_Trace.hpp"
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+namespace {
+
+   // The number of messages the ring buffer can hold
+   const uint64_t RING_CAPACITY = 1024;
+
+   // The number of bytes of console output carried by a single message
+   const size_t PAYLOAD_SIZE = 480;
+
+   // The kinds of message sent by workers
+   enum MessageKind : uint32_t {
+      SUITE_BEGIN = 0,
+      SUITE_OUTPUT = 1,
+      SUITE_DURATION = 2,
+      SUITE_END = 3,
+      SUITE_BASELINE = 4,
+      SUITE_NOTES = 5,
+      SUITE_EXECUTED = 6
+   };
+
+   // A slot of the ring buffer, sequence tells whether it is free or holds a message
+   struct Message {
+      std::atomic<uint64_t> sequence;
+      uint32_t kind;
+      uint32_t suite;
+      int32_t pid;
+      int32_t executed;
+      int32_t failed;
+      int32_t ret;
+      double duration;
+      uint32_t size;
+      char payload[PAYLOAD_SIZE];
+   };
+
+   // What the parent knows about each UT_TEST_SUITE
+   struct SuiteResult {
+      bool started = false;
+      bool finished = false;
+      int pid = 0;
+      int executed = 0;
+      int failed = 0;
+      bool ret = true;
+      std::string output;
+      std::string notes;
+      std::string error;
+   };
+
+   // It tells whether a UT_TEST_SUITE has selected cases that must be executed alone (e.g. UT_BENCHMARKs)
+   bool has_exclusive_cases(const char *name) {
+      UnitTest::SuiteEntry *entry = UnitTest::Registry::find(name);
+      for (UnitTest::CaseEntry *test_case = (entry != nullptr) ? entry->cases : nullptr; test_case != nullptr; test_case = test_case->next)
+         if (test_case->exclusive && test_case->selected) return true;
+      return false;
+   }
+
+   void pause_briefly() {
+      struct timespec ts = {0, 100000};
+      nanosleep(&ts, nullptr);
+   }
+
+   void push(Message *slots, std::atomic<uint64_t> &head, uint32_t kind, uint32_t suite,
+             int executed, int failed, bool ret, double duration, const char *data, size_t size) {
+
+      uint64_t ticket = head.fetch_add(1);
+      Message &slot = slots[ticket % RING_CAPACITY];
+
+      // It waits for the parent to consume the message previously held by the slot
+      while (slot.sequence.load(std::memory_order_acquire) != ticket) pause_briefly();
+
+      slot.kind = kind;
+      slot.suite = suite;
+      slot.pid = static_cast<int32_t>(getpid());
+      slot.executed = executed;
+      slot.failed = failed;
+      slot.ret = ret ? 1 : 0;
+      slot.duration = duration;
+      slot.size = static_cast<uint32_t>(size);
+      if (size > 0) std::memcpy(slot.payload, data, size);
+      slot.sequence.store(ticket + 1, std::memory_order_release);
+   }
+
+}
+
+// The shared memory area: a bounded multi-producer single-consumer ring buffer. The first shared
+// positions of the order are taken by any worker, the others (suites with exclusive cases) by the
+// worker owning them, once the shared ones are finished.
+struct UnitTest::Workers::Ring {
+   uint64_t shared;
+   std::atomic<uint64_t> next_suite;
+   std::atomic<uint64_t> finished;
+   std::atomic<uint64_t> next_exclusive;
+   std::atomic<int32_t> owner;
+   std::atomic<uint64_t> head;
+   Message slots[RING_CAPACITY];
+};
+
+void UnitTest::Workers::worker(Ring *ring, const std::vector<size_t> &suites, const std::vector<size_t> &order) {
+
+   std::stringstream output;
+   std::vector<std::pair<std::string, double>> durations;
+   ::Console::SetStream(&output);
+
+   // Suites with exclusive cases are executed one at a time by a single worker, while no other
+   // suite is executed: the workers left without shared suites terminate
+   int32_t self = static_cast<int32_t>(getpid());
+   auto take = [&]() -> uint64_t {
+      uint64_t next = ring->next_suite.fetch_add(1);
+      if (next < ring->shared) return next;
+      int32_t owner = 0;
+      if (!ring->owner.compare_exchange_strong(owner, self) && owner != self) return order.size();
+      while (ring->finished.load() < ring->shared) pause_briefly();
+      return ring->shared + ring->next_exclusive.fetch_add(1);
+   };
+
+   for (uint64_t next = take(); next < order.size(); next = take()) {
+      size_t idx = order[next];
+      uint32_t suite = static_cast<uint32_t>(idx);
+      push(ring->slots, ring->head, SUITE_BEGIN, suite, 0, 0, true, 0.0, nullptr, 0);
+
+      TestManager::execute_suite(suites[idx]);
+
+      // The console output of the suite is sent in chunks followed by its outcome
+      std::string content = output.str();
+      for (size_t offset = 0; offset < content.size(); offset += PAYLOAD_SIZE) {
+         size_t size = std::min(PAYLOAD_SIZE, content.size() - offset);
+         push(ring->slots, ring->head, SUITE_OUTPUT, suite, 0, 0, true, 0.0, content.data() + offset, size);
+      }
+      output.str(std::string());
+
+      // The measured durations are recorded by the parent process
+      UnitTest::Durations::take_pending(durations);
+      for (auto it = std::begin(durations); it != std::end(durations); ++it) {
+         if (it->first.size() > PAYLOAD_SIZE) continue;
+         push(ring->slots, ring->head, SUITE_DURATION, suite, 0, 0, true, it->second, it->first.data(), it->first.size());
+      }
+      durations.clear();
+
+      // So are the results compared with the baseline
+      UnitTest::Baseline::take_pending(durations);
+      for (auto it = std::begin(durations); it != std::end(durations); ++it) {
+         if (it->first.size() > PAYLOAD_SIZE) continue;
+         push(ring->slots, ring->head, SUITE_BASELINE, suite, 0, 0, true, it->second, it->first.data(), it->first.size());
+      }
+      durations.clear();
+
+      // And the UT_TEST_CASEs whose baseline results are complete
+      std::vector<std::string> executed;
+      UnitTest::Baseline::take_executed(executed);
+      for (auto it = std::begin(executed); it != std::end(executed); ++it) {
+         if (it->size() > PAYLOAD_SIZE) continue;
+         push(ring->slots, ring->head, SUITE_EXECUTED, suite, 0, 0, true, 0.0, it->data(), it->size());
+      }
+
+      // The notes of the footer are written by the parent process
+      for (size_t offset = 0; offset < TestManager::m_notes.size(); offset += PAYLOAD_SIZE) {
+         size_t size = std::min(PAYLOAD_SIZE, TestManager::m_notes.size() - offset);
+         push(ring->slots, ring->head, SUITE_NOTES, suite, 0, 0, true, 0.0, TestManager::m_notes.data() + offset, size);
+      }
+
+      push(ring->slots, ring->head, SUITE_END, suite,
+           TestManager::m_number_of_executed_cases,
+           TestManager::m_number_of_failed_cases,
+           TestManager::m_ret, 0.0, nullptr, 0);
+      TestManager::reset_suite();
+      if (next < ring->shared) ++ring->finished;
+   }
+
+   ::Console::SetStream(nullptr);
+}
+
+int UnitTest::Workers::spawn(Ring *ring, const std::vector<size_t> &suites, const std::vector<size_t> &order) {
+   std::cout << std::flush;
+   pid_t pid = fork();
+   if (pid == 0) {
+      UnitTest::Trace::forked();
+      Workers::worker(ring, suites, order);
+      UnitTest::Trace::save_part();
+      std::cout << std::flush;
+      _exit(0);
+   }
+   if (pid > 0) UnitTest::Trace::add_part(static_cast<int>(pid));
+   return static_cast<int>(pid);
+}
+
+bool UnitTest::Workers::available() {
+   return true;
+}
+
+void UnitTest::Workers::run(const std::vector<size_t> &suites, unsigned jobs) {
+
+   void *area = mmap(nullptr, sizeof(Ring), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+   if (area == MAP_FAILED) {
+      std::string error = "Unable to allocate shared memory, UT_TEST_SUITEs will be executed sequentially\n";
+      ::Console::WriteError(error);
+      TestManager::m_jobs = 1;
+      for (auto it = std::begin(suites); it != std::end(suites); ++it) {
+         TestManager::write_suite_header(std::get<0>(TestManager::m_cases[*it]));
+         TestManager::execute_suite(*it);
+         TestManager::write_suite_footer();
+         TestManager::reset_suite();
+      }
+      return;
+   }
+
+   // Shared suites are started from the longest one, suites with exclusive cases follow them in
+   // registration order
+   std::vector<std::string> keys;
+   std::vector<size_t> shared, order;
+   std::vector<bool> exclusive(suites.size(), false);
+   for (size_t idx = 0; idx < suites.size(); ++idx) {
+      const char *name = std::get<0>(TestManager::m_cases[suites[idx]]);
+      exclusive[idx] = has_exclusive_cases(name);
+      if (exclusive[idx]) continue;
+      shared.push_back(idx);
+      keys.push_back(name);
+   }
+   std::vector<size_t> longest = UnitTest::Durations::longest_first(keys);
+   for (auto it = std::begin(longest); it != std::end(longest); ++it) order.push_back(shared[*it]);
+   for (size_t idx = 0; idx < suites.size(); ++idx)
+      if (exclusive[idx]) order.push_back(idx);
+
+   Ring *ring = new(area) Ring();
+   ring->shared = shared.size();
+   ring->next_suite.store(0);
+   ring->finished.store(0);
+   ring->next_exclusive.store(0);
+   ring->owner.store(0);
+   ring->head.store(0);
+   for (uint64_t idx = 0; idx < RING_CAPACITY; ++idx) ring->slots[idx].sequence.store(idx);
+   uint64_t tail = 0;
+
+   std::vector<SuiteResult> results(suites.size());
+   std::vector<int> children;
+   for (unsigned idx = 0; idx < std::min<size_t>(jobs, suites.size()); ++idx) {
+      int pid = spawn(ring, suites, order);
+      if (pid > 0) children.push_back(pid);
+   }
+
+   size_t next_print = 0;
+   bool death_observed = false;
+   struct timespec stuck_since = {0, 0};
+
+   // It writes, in registration order, the UT_TEST_SUITEs whose outcome is known
+   auto print_finished = [&]() -> void {
+      while (next_print < results.size() && results[next_print].finished) {
+         SuiteResult &result = results[next_print];
+         TestManager::write_suite_header(std::get<0>(TestManager::m_cases[suites[next_print]]));
+         ::Console::WriteRaw(result.output);
+         if (!result.error.empty()) ::Console::WriteError(result.error);
+         TestManager::m_number_of_executed_cases = result.executed;
+         TestManager::m_number_of_failed_cases = result.failed;
+         TestManager::m_ret = result.ret;
+         TestManager::m_notes = result.notes;
+         TestManager::write_suite_footer();
+         TestManager::reset_suite();
+         result.output.clear();
+         result.notes.clear();
+         ++next_print;
+      }
+   };
+
+   // It consumes all published messages, it returns true when at least one has been consumed
+   auto drain = [&]() -> bool {
+      bool consumed = false;
+      while (true) {
+         Message &slot = ring->slots[tail % RING_CAPACITY];
+         if (slot.sequence.load(std::memory_order_acquire) != tail + 1) break;
+
+         SuiteResult &result = results[slot.suite];
+         switch (slot.kind) {
+            case SUITE_BEGIN:
+               result.started = true;
+               result.pid = slot.pid;
+               break;
+            case SUITE_OUTPUT:
+               result.output.append(slot.payload, slot.size);
+               break;
+            case SUITE_DURATION:
+               UnitTest::Durations::record(std::string(slot.payload, slot.size), slot.duration);
+               break;
+            case SUITE_NOTES:
+               result.notes.append(slot.payload, slot.size);
+               break;
+            case SUITE_BASELINE:
+               UnitTest::Baseline::record(std::string(slot.payload, slot.size), slot.duration);
+               break;
+            case SUITE_EXECUTED:
+               UnitTest::Baseline::executed(std::string(slot.payload, slot.size));
+               break;
+            case SUITE_END:
+               result.executed = slot.executed;
+               result.failed = slot.failed;
+               result.ret = (slot.ret != 0);
+               result.finished = true;
+               break;
+         }
+
+         slot.sequence.store(tail + RING_CAPACITY, std::memory_order_release);
+         ++tail;
+         consumed = true;
+      }
+      return consumed;
+   };
+
+   while (next_print < results.size()) {
+
+      if (drain()) {
+         print_finished();
+         stuck_since.tv_sec = 0;
+         continue;
+      }
+
+      // It reaps terminated workers, the suite a crashed worker was executing is reported as failed
+      int status = 0;
+      pid_t pid = waitpid(-1, &status, WNOHANG);
+      if (pid > 0) {
+         children.erase(std::remove(children.begin(), children.end(), pid), children.end());
+         drain();
+
+         bool crashed = !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+         if (crashed) {
+            death_observed = true;
+            for (auto it = std::begin(results); it != std::end(results); ++it) {
+               if (it->started && !it->finished && it->pid == pid) {
+                  std::stringstream ss;
+                  ss << "  Worker process " << pid << " terminated ";
+                  if (WIFSIGNALED(status)) ss << "by signal " << WTERMSIG(status);
+                  else ss << "with exit code " << WEXITSTATUS(status);
+                  ss << " while executing the suite" << std::endl;
+                  it->error = ss.str();
+                  it->ret = false;
+                  it->finished = true;
+                  if (!exclusive[it - std::begin(results)]) ++ring->finished;
+               }
+            }
+
+            // The suites with exclusive cases left by a crashed owner are taken by its replacement
+            int32_t owner = static_cast<int32_t>(pid);
+            ring->owner.compare_exchange_strong(owner, 0);
+            if (ring->next_suite.load() < ring->shared || ring->next_exclusive.load() < suites.size() - ring->shared) {
+               int replacement = spawn(ring, suites, order);
+               if (replacement > 0) children.push_back(replacement);
+            }
+         }
+
+         print_finished();
+         continue;
+      }
+
+      // A worker terminated while publishing a message would block the ring forever: once no
+      // progress has been made for a second since a crash, its slot is skipped
+      if (death_observed && ring->head.load() > tail) {
+         struct timespec now;
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         if (stuck_since.tv_sec == 0) stuck_since = now;
+         else if (now.tv_sec - stuck_since.tv_sec > 1) {
+            ring->slots[tail % RING_CAPACITY].sequence.store(tail + RING_CAPACITY, std::memory_order_release);
+            ++tail;
+            stuck_since.tv_sec = 0;
+         }
+      }
+
+      // No worker is left: suites never started are reported as failed
+      if (children.empty() && ring->head.load() == tail) {
+         for (auto it = std::begin(results); it != std::end(results); ++it) {
+            if (!it->finished) {
+               it->error = "  No worker process left to execute the suite\n";
+               it->ret = false;
+               it->finished = true;
+            }
+         }
+         print_finished();
+         break;
+      }
+
+      pause_briefly();
+   }
+
+   for (auto it = std::begin(children); it != std::end(children); ++it) waitpid(*it, nullptr, 0);
+   ring->~Ring();
+   munmap(area, sizeof(Ring));
+}
+
+#else
+
+bool UnitTest::Workers::available() {
+   return false;
+}
+
+void UnitTest::Workers::run(const std::vector<size_t> &, unsigned) {
+}
+
+#endif
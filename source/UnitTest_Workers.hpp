@@ -0,0 +1,120 @@
+/*
+The MIT License(MIT)
+
+Copyright(c) 2016-2017 Giovanni Lombardo
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this
+software and associated documentation files(the "Software"), to deal in the Software
+without restriction, including without limitation the rights to use, copy, modify,
+merge, publish, distribute, sublicense, and / or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to the following
+conditions :
+
+The above copyright notice and this permission notice shall be included in all copies
+or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <vector>
+#include <cstddef>
+
+#ifndef _UNIT_TEST_WORKERS_HPP_
+#define _UNIT_TEST_WORKERS_HPP_
+
+namespace UnitTest {
+
+    /*!
+     * \brief
+     * It executes UT_TEST_SUITEs in a pool of forked worker processes. Workers take the next
+     * UT_TEST_SUITE to be executed from a counter kept in shared memory and send back their
+     * outcome and console output through a shared memory ring buffer, the parent process
+     * collects them and writes the report in the registration order of the UT_TEST_SUITEs.
+     * UT_TEST_SUITEs are started from the longest one according to the known Durations: taking
+     * them in this order from a shared queue packs the work on the workers that get free first.
+     * UT_TEST_SUITEs having exclusive cases (e.g. UT_BENCHMARKs) are executed last, one at a time
+     * by a single worker, so that no other UT_TEST_SUITE disturbs their measurements.
+     **/
+    class Workers {
+
+    private:
+
+        // The shared memory area used to distribute UT_TEST_SUITEs and to collect their outcome.
+        struct Ring;
+
+        /*!
+         * \brief
+         * It executes UT_TEST_SUITEs in a worker process until there are no more left.
+         *
+         * \param[in] ring
+         * The shared memory area.
+         *
+         * \param[in] suites
+         * The indexes of the registered UT_TEST_SUITEs to be executed.
+         *
+         * \param[in] order
+         * The positions in suites, in the order UT_TEST_SUITEs must be started.
+         *
+         * \returns
+         * void.
+         */
+        static void worker(Ring *ring, const std::vector<size_t> &suites, const std::vector<size_t> &order);
+
+        /*!
+         * \brief
+         * It forks a new worker process.
+         *
+         * \param[in] ring
+         * The shared memory area.
+         *
+         * \param[in] suites
+         * The indexes of the registered UT_TEST_SUITEs to be executed.
+         *
+         * \param[in] order
+         * The positions in suites, in the order UT_TEST_SUITEs must be started.
+         *
+         * \returns
+         * The pid of the worker process, a negative value on failure.
+         */
+        static int spawn(Ring *ring, const std::vector<size_t> &suites, const std::vector<size_t> &order);
+
+    public:
+
+        /*!
+         * \brief
+         * It returns whether or not worker processes are supported on the current platform.
+         *
+         * \returns
+         * See the brief description.
+         */
+        static bool available();
+
+        /*!
+         * \brief
+         * It executes the given UT_TEST_SUITEs using the given number of worker processes.
+         *
+         * \param[in] suites
+         * The indexes of the registered UT_TEST_SUITEs to be executed.
+         *
+         * \param[in] jobs
+         * The number of worker processes.
+         *
+         * \returns
+         * void.
+         *
+         * \notes
+         * A worker terminated while executing a UT_TEST_SUITE (e.g. by a crash) is replaced by a
+         * new one and the UT_TEST_SUITE it was executing is reported as failed.
+         */
+        static void run(const std::vector<size_t> &suites, unsigned jobs);
+    };
+
+}
+
+#endif // _UNIT_TEST_WORKERS_HPP_